@@ -0,0 +1,16 @@
+/**
+ * @file Arduino.cpp
+ * @brief Horloge virtuelle et port série de l'environnement native.
+ */
+
+#include "Arduino.h"
+
+uint64_t NativeClock::_us = 0;
+uint32_t NativeClock::_yieldUs = 0;
+
+HardwareSerial Serial;
+
+char* dtostrf(double value, signed char width, unsigned char prec, char* buf) {
+  sprintf(buf, "%*.*f", width, prec, value);
+  return buf;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file Arduino.h
+ * @brief API Arduino minimale pour compiler src/core et src/devices sur PC.
+ *
+ * L'environnement native de platformio.ini remplace le core ESP8266
+ * par ces shims.  Le temps est virtuel : millis() et micros() ne
+ * progressent que par NativeClock::advanceUs(), delay(),
+ * delayMicroseconds() et yield().  Un programme hôte déroule ainsi des
+ * secondes d'acquisition en quelques millisecondes, de façon
+ * reproductible.  Les E/S analogiques et numériques sont sans effet ;
+ * les signaux d'entrée viennent du pilote "sim" de l'IORegistry.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "WString.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define TWO_PI 6.283185307179586476925286766559
+#define HEX 16
+#define DEC 10
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+
+// Broches NodeMCU (numéros GPIO), sans effet sur PC
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define A0 17
+
+#define PROGMEM
+#define F(s) (s)
+#define pgm_read_byte(p) (*reinterpret_cast<const uint8_t*>(p))
+#define pgm_read_word(p) (*reinterpret_cast<const uint16_t*>(p))
+#define pgm_read_dword(p) (*reinterpret_cast<const uint32_t*>(p))
+
+/** Horloge virtuelle de l'environnement native. */
+class NativeClock {
+public:
+  static uint32_t micros() { return static_cast<uint32_t>(_us); }
+  static uint32_t millis() { return static_cast<uint32_t>(_us / 1000); }
+  /** Avance le temps virtuel de `us` microsecondes. */
+  static void advanceUs(uint64_t us) { _us += us; }
+  /** Remet le temps virtuel à `us`. */
+  static void set(uint64_t us) { _us = us; }
+  /** Durée ajoutée par chaque yield() (par défaut 0). */
+  static void setYieldUs(uint32_t us) { _yieldUs = us; }
+  static uint32_t yieldUs() { return _yieldUs; }
+private:
+  static uint64_t _us;
+  static uint32_t _yieldUs;
+};
+
+inline uint32_t micros() { return NativeClock::micros(); }
+inline uint32_t millis() { return NativeClock::millis(); }
+inline void delay(uint32_t ms) { NativeClock::advanceUs(static_cast<uint64_t>(ms) * 1000); }
+inline void delayMicroseconds(uint32_t us) { NativeClock::advanceUs(us); }
+inline void yield() { NativeClock::advanceUs(NativeClock::yieldUs()); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline int analogRead(uint8_t) { return 0; }
+inline void analogWrite(uint8_t, int) {}
+inline void analogWriteRange(uint32_t) {}
+inline void analogWriteFreq(uint32_t) {}
+
+template <typename T>
+inline T constrain(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+char* dtostrf(double value, signed char width, unsigned char prec, char* buf);
+
+/** Port série redirigé vers la sortie standard. */
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  size_t print(const String& s) {
+    if (_quiet || fputs(s.c_str(), stdout) < 0) return 0;
+    return s.length();
+  }
+  size_t print(const char* s) { return print(String(s)); }
+  size_t println(const String& s) { return print(s) + print("\n"); }
+  size_t println(const char* s) { return println(String(s)); }
+  size_t println() { return print("\n"); }
+  /** Supprime l'écho (bancs d'essai). */
+  void setQuiet(bool quiet) { _quiet = quiet; }
+  bool quiet() const { return _quiet; }
+private:
+  bool _quiet = false;
+};
+
+extern HardwareSerial Serial;
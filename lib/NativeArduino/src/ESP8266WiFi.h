@@ -0,0 +1,9 @@
+/**
+ * @file ESP8266WiFi.h
+ * @brief Sous-ensemble réseau de l'environnement native (adresses, UDP).
+ */
+
+#pragma once
+
+#include "IPAddress.h"
+#include "WiFiUdp.h"
@@ -0,0 +1,20 @@
+/**
+ * @file IPAddress.h
+ * @brief Adresse IPv4 compatible Arduino pour l'environnement native.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress() : _addr{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+  bool fromString(const char* text);
+  String toString() const;
+  explicit operator bool() const { return _addr[0] | _addr[1] | _addr[2] | _addr[3]; }
+  uint8_t operator[](int i) const { return _addr[i]; }
+private:
+  uint8_t _addr[4];
+};
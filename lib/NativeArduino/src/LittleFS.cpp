@@ -0,0 +1,100 @@
+/**
+ * @file LittleFS.cpp
+ * @brief Implémentation du LittleFS hôte (fichiers stdio sous une racine).
+ */
+
+#include "LittleFS.h"
+
+#include <filesystem>
+#include <system_error>
+
+NativeFS LittleFS;
+
+int File::read() {
+  if (!_fp) return -1;
+  int c = fgetc(_fp.get());
+  return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  return _fp ? fread(buf, 1, size, _fp.get()) : 0;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  return _fp ? fwrite(buf, 1, size, _fp.get()) : 0;
+}
+
+int File::available() {
+  if (!_fp) return 0;
+  long remaining = static_cast<long>(size()) - static_cast<long>(position());
+  return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+bool File::seek(uint32_t pos) {
+  return _fp && fseek(_fp.get(), static_cast<long>(pos), SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  if (!_fp) return 0;
+  long pos = ftell(_fp.get());
+  return pos < 0 ? 0 : static_cast<size_t>(pos);
+}
+
+size_t File::size() const {
+  if (!_fp) return 0;
+  FILE* fp = _fp.get();
+  long pos = ftell(fp);
+  fseek(fp, 0, SEEK_END);
+  long end = ftell(fp);
+  fseek(fp, pos, SEEK_SET);
+  return end < 0 ? 0 : static_cast<size_t>(end);
+}
+
+void File::flush() {
+  if (_fp) fflush(_fp.get());
+}
+
+String NativeFS::hostPath(const String& path) const {
+  if (path.startsWith("/")) return _root + path;
+  return _root + "/" + path;
+}
+
+bool NativeFS::format() {
+  std::error_code ec;
+  std::filesystem::remove_all(_root.c_str(), ec);
+  return std::filesystem::create_directories(_root.c_str(), ec) || !ec;
+}
+
+bool NativeFS::exists(const String& path) {
+  std::error_code ec;
+  return std::filesystem::exists(hostPath(path).c_str(), ec);
+}
+
+bool NativeFS::mkdir(const String& path) {
+  std::error_code ec;
+  std::filesystem::create_directories(hostPath(path).c_str(), ec);
+  return !ec;
+}
+
+bool NativeFS::remove(const String& path) {
+  std::error_code ec;
+  return std::filesystem::remove(hostPath(path).c_str(), ec);
+}
+
+bool NativeFS::rename(const String& from, const String& to) {
+  std::error_code ec;
+  std::filesystem::rename(hostPath(from).c_str(), hostPath(to).c_str(), ec);
+  return !ec;
+}
+
+File NativeFS::open(const String& path, const char* mode) {
+  File f;
+  // Mode binaire : les traces et tampons sont lus octet pour octet
+  String m = String(mode) + "b";
+  FILE* fp = fopen(hostPath(path).c_str(), m.c_str());
+  if (fp) {
+    f._fp = std::shared_ptr<FILE>(fp, fclose);
+    f._name = path;
+  }
+  return f;
+}
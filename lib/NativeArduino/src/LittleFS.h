@@ -0,0 +1,62 @@
+/**
+ * @file LittleFS.h
+ * @brief LittleFS de l'environnement native, adossé à un répertoire hôte.
+ *
+ * Les chemins absolus de la carte ("/configuration/io.json") sont
+ * résolus sous la racine choisie par LittleFS.setRoot() (par défaut
+ * le répertoire courant), par exemple le dossier data/ du projet.
+ */
+
+#pragma once
+
+#include <memory>
+#include <stdio.h>
+
+#include "Arduino.h"
+
+class File {
+public:
+  File() {}
+  explicit operator bool() const { return static_cast<bool>(_fp); }
+
+  int read();
+  size_t read(uint8_t* buf, size_t size);
+  size_t readBytes(char* buf, size_t size) { return read(reinterpret_cast<uint8_t*>(buf), size); }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size);
+  size_t print(const String& s) { return write(reinterpret_cast<const uint8_t*>(s.c_str()), s.length()); }
+  int available();
+  bool seek(uint32_t pos);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close() { _fp.reset(); }
+  const char* name() const { return _name.c_str(); }
+
+private:
+  friend class NativeFS;
+  std::shared_ptr<FILE> _fp;
+  String _name;
+};
+
+class NativeFS {
+public:
+  /** Choisit le répertoire hôte servant de racine. */
+  void setRoot(const String& dir) { _root = dir; }
+  const String& root() const { return _root; }
+  bool begin() { return true; }
+  void end() {}
+  bool format();
+  bool exists(const String& path);
+  bool mkdir(const String& path);
+  bool remove(const String& path);
+  bool rename(const String& from, const String& to);
+  /** Ouvre un fichier ("r", "w", "a", "r+"...) ; File invalide en cas d'échec. */
+  File open(const String& path, const char* mode = "r");
+
+private:
+  String _root = ".";
+  String hostPath(const String& path) const;
+};
+
+extern NativeFS LittleFS;
@@ -0,0 +1,117 @@
+/**
+ * @file WString.cpp
+ * @brief Implémentation de la classe String de l'environnement native.
+ */
+
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char buf[72];
+  char* p = buf + sizeof(buf);
+  *--p = 0;
+  do {
+    unsigned digit = value % base;
+    *--p = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value);
+  if (negative) *--p = '-';
+  return p;
+}
+
+static std::string formatFloat(double value, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  return buf;
+}
+
+// Comme sur Arduino, une base autre que 10 affiche le complément à deux
+String::String(int value, unsigned char base)
+  : _s(base == 10 && value < 0 ? formatInteger(0UL - static_cast<unsigned long>(value), true, 10)
+                               : formatInteger(static_cast<unsigned int>(value), false, base)) {}
+String::String(unsigned int value, unsigned char base) : _s(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base)
+  : _s(base == 10 && value < 0 ? formatInteger(0UL - static_cast<unsigned long>(value), true, 10)
+                               : formatInteger(static_cast<unsigned long>(value), false, base)) {}
+String::String(unsigned long value, unsigned char base) : _s(formatInteger(value, false, base)) {}
+String::String(float value, unsigned char decimals) : _s(formatFloat(value, decimals)) {}
+String::String(double value, unsigned char decimals) : _s(formatFloat(value, decimals)) {}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t pos = _s.find(c, from);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+  size_t pos = _s.find(s._s, from);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char c) const {
+  size_t pos = _s.rfind(c);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+bool String::endsWith(const String& suffix) const {
+  return _s.size() >= suffix._s.size() &&
+         _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+}
+
+String String::substring(unsigned int from) const {
+  return from < _s.size() ? String(_s.substr(from)) : String();
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int tmp = from;
+    from = to;
+    to = tmp;
+  }
+  if (from >= _s.size()) return String();
+  return String(_s.substr(from, to - from));
+}
+
+void String::replace(const String& from, const String& to) {
+  if (from._s.empty()) return;
+  size_t pos = 0;
+  while ((pos = _s.find(from._s, pos)) != std::string::npos) {
+    _s.replace(pos, from._s.size(), to._s);
+    pos += to._s.size();
+  }
+}
+
+void String::trim() {
+  size_t first = _s.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    _s.clear();
+    return;
+  }
+  size_t last = _s.find_last_not_of(" \t\r\n");
+  _s = _s.substr(first, last - first + 1);
+}
+
+void String::toLowerCase() {
+  for (auto& c : _s) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+}
+
+void String::toUpperCase() {
+  for (auto& c : _s) c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+}
+
+long String::toInt() const { return atol(_s.c_str()); }
+float String::toFloat() const { return static_cast<float>(atof(_s.c_str())); }
+
+String operator+(const String& a, const String& b) { String r(a); r.concat(b); return r; }
+String operator+(const String& a, const char* b) { String r(a); r.concat(b); return r; }
+String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+String operator+(const String& a, char b) { String r(a); r.concat(b); return r; }
+String operator+(const String& a, int b) { return a + String(b); }
+String operator+(const String& a, unsigned int b) { return a + String(b); }
+String operator+(const String& a, long b) { return a + String(b); }
+String operator+(const String& a, unsigned long b) { return a + String(b); }
+String operator+(const String& a, float b) { return a + String(b); }
+String operator+(const String& a, double b) { return a + String(b); }
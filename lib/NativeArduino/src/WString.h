@@ -0,0 +1,84 @@
+/**
+ * @file WString.h
+ * @brief Classe String compatible Arduino pour l'environnement native.
+ *
+ * Seul le sous-ensemble utilisé par src/core et src/devices est
+ * fourni, au-dessus de std::string.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  String(const std::string& s) : _s(s) {}
+  String(char c) : _s(1, c) {}
+  String(int value, unsigned char base = 10);
+  String(unsigned int value, unsigned char base = 10);
+  String(long value, unsigned char base = 10);
+  String(unsigned long value, unsigned char base = 10);
+  String(unsigned char value, unsigned char base = 10) : String(static_cast<unsigned int>(value), base) {}
+  String(float value, unsigned char decimals = 2);
+  String(double value, unsigned char decimals = 2);
+
+  String& operator=(const char* s) {
+    _s = s ? s : "";
+    return *this;
+  }
+
+  const char* c_str() const { return _s.c_str(); }
+  unsigned int length() const { return static_cast<unsigned int>(_s.size()); }
+  bool isEmpty() const { return _s.empty(); }
+  void reserve(unsigned int size) { _s.reserve(size); }
+  void clear() { _s.clear(); }
+
+  bool concat(const String& s) { _s += s._s; return true; }
+  bool concat(const char* s) { if (s) _s += s; return true; }
+  bool concat(const char* s, unsigned int n) { _s.append(s, n); return true; }
+  bool concat(char c) { _s += c; return true; }
+  String& operator+=(const String& s) { _s += s._s; return *this; }
+  String& operator+=(const char* s) { if (s) _s += s; return *this; }
+  String& operator+=(char c) { _s += c; return *this; }
+
+  bool operator==(const String& s) const { return _s == s._s; }
+  bool operator==(const char* s) const { return _s == (s ? s : ""); }
+  bool operator!=(const String& s) const { return _s != s._s; }
+  bool operator!=(const char* s) const { return !(*this == s); }
+  bool operator<(const String& s) const { return _s < s._s; }
+  bool equals(const String& s) const { return _s == s._s; }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String& s, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+  bool endsWith(const String& suffix) const;
+  String substring(unsigned int from) const;
+  String substring(unsigned int from, unsigned int to) const;
+  void replace(const String& from, const String& to);
+  void trim();
+  void toLowerCase();
+  void toUpperCase();
+  long toInt() const;
+  float toFloat() const;
+
+private:
+  std::string _s;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+String operator+(const String& a, int b);
+String operator+(const String& a, unsigned int b);
+String operator+(const String& a, long b);
+String operator+(const String& a, unsigned long b);
+String operator+(const String& a, float b);
+String operator+(const String& a, double b);
@@ -0,0 +1,46 @@
+/**
+ * @file WiFiUdp.cpp
+ * @brief Adresses IPv4 et UDP simulé de l'environnement native.
+ */
+
+#include "WiFiUdp.h"
+
+WiFiUDP::Sink WiFiUDP::_sink = nullptr;
+
+bool IPAddress::fromString(const char* text) {
+  unsigned a, b, c, d;
+  char extra;
+  if (!text || sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 ||
+      a > 255 || b > 255 || c > 255 || d > 255) {
+    return false;
+  }
+  _addr[0] = static_cast<uint8_t>(a);
+  _addr[1] = static_cast<uint8_t>(b);
+  _addr[2] = static_cast<uint8_t>(c);
+  _addr[3] = static_cast<uint8_t>(d);
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+  return String(buf);
+}
+
+int WiFiUDP::beginPacket(IPAddress dest, uint16_t port) {
+  _dest = dest;
+  _destPort = port;
+  _packet.clear();
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t len) {
+  _packet.insert(_packet.end(), data, data + len);
+  return len;
+}
+
+int WiFiUDP::endPacket() {
+  if (_sink) _sink(_dest, _destPort, _packet.data(), _packet.size());
+  _packet.clear();
+  return 1;
+}
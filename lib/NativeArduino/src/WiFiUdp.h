@@ -0,0 +1,41 @@
+/**
+ * @file WiFiUdp.h
+ * @brief WiFiUDP de l'environnement native : les paquets émis sont
+ * remis à un observateur au lieu du réseau.
+ *
+ * Aucun paquet n'est jamais reçu.  Le programme hôte installe un
+ * observateur (setSink()) pour journaliser ou comparer les paquets
+ * émis, par exemple ceux de UDPServer lors du rejeu d'une trace.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiUDP {
+public:
+  typedef void (*Sink)(const IPAddress& dest, uint16_t port, const uint8_t* data, size_t len);
+
+  /** Observateur des paquets émis par toutes les instances. */
+  static void setSink(Sink sink) { _sink = sink; }
+
+  uint8_t begin(uint16_t port) { _port = port; return 1; }
+  void stop() {}
+  int parsePacket() { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+  int beginPacket(IPAddress dest, uint16_t port);
+  size_t write(uint8_t c) { _packet.push_back(c); return 1; }
+  size_t write(const uint8_t* data, size_t len);
+  int endPacket();
+
+private:
+  static Sink _sink;
+  uint16_t _port = 0;
+  IPAddress _dest;
+  uint16_t _destPort = 0;
+  std::vector<uint8_t> _packet;
+};
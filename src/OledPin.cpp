@@ -4,16 +4,68 @@
  */
 
 #include "OledPin.h"
+#include "core/I2CManager.h"
 #include "core/IORegistry.h"
 
-#include <Wire.h>
 #include <deque>
 
-// Définit un écran SSD1306 128x64 I2C en mode matériel.  Les broches
-// d'horloge (SCL) et de données (SDA) sont fixées à 14 et 12 pour
-// correspondre au schéma fourni par l'utilisateur.
-static U8G2_SSD1306_128X64_NONAME_F_HW_I2C _oled(
-    U8G2_R0, /* reset=*/ U8X8_PIN_NONE, /* clock=*/ 14, /* data=*/ 12);
+namespace {
+  // Transfert U8g2 en cours de constitution (au plus 25 octets : octet
+  // de contrôle puis 24 octets de données, cf. u8x8_cad_ssd13xx_fast_i2c).
+  uint8_t _txBuf[I2CManager::MAX_CHUNK];
+  size_t _txLen = 0;
+
+  /**
+   * Callback octet U8g2 : au lieu d'écrire directement sur Wire, chaque
+   * transfert est déposé dans la file d'affichage de l'I2CManager, qui
+   * l'enverra entre les transactions synchrones des convertisseurs.
+   * Le bus est démarré et cadencé par l'I2CManager (pas de
+   * Wire.setClock() ici).
+   */
+  uint8_t byteManagedI2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
+    switch (msg) {
+      case U8X8_MSG_BYTE_SEND: {
+        const uint8_t* data = static_cast<const uint8_t*>(arg_ptr);
+        for (uint8_t i = 0; i < arg_int && _txLen < sizeof(_txBuf); ++i) {
+          _txBuf[_txLen++] = data[i];
+        }
+        break;
+      }
+      case U8X8_MSG_BYTE_INIT:
+      case U8X8_MSG_BYTE_SET_DC:
+        break;
+      case U8X8_MSG_BYTE_START_TRANSFER:
+        _txLen = 0;
+        break;
+      case U8X8_MSG_BYTE_END_TRANSFER: {
+        uint8_t addr = u8x8_GetI2CAddress(u8x8) >> 1;
+        if (!I2CManager::submit(addr, _txBuf, _txLen)) {
+          // File pleine : on envoie ce qui attend pour faire de la place
+          I2CManager::flush();
+          I2CManager::submit(addr, _txBuf, _txLen);
+        }
+        break;
+      }
+      default:
+        return 0;
+    }
+    return 1;
+  }
+
+  /** SSD1306 128x64 en tampon complet, transferts via l'I2CManager. */
+  class U8G2_SSD1306_128X64_NONAME_F_MANAGED_I2C : public U8G2 {
+  public:
+    explicit U8G2_SSD1306_128X64_NONAME_F_MANAGED_I2C(const u8g2_cb_t *rotation) : U8G2() {
+      u8g2_Setup_ssd1306_i2c_128x64_noname_f(&u8g2, rotation, byteManagedI2c,
+                                             u8x8_gpio_and_delay_arduino);
+    }
+  };
+}
+
+// Définit un écran SSD1306 128x64 I2C.  Le bus (SDA=12, SCL=14 selon
+// le schéma fourni par l'utilisateur) est partagé avec les convertisseurs
+// et géré par l'I2CManager.
+static U8G2_SSD1306_128X64_NONAME_F_MANAGED_I2C _oled(U8G2_R0);
 
 namespace {
   static const unsigned long SCROLL_INTERVAL_MS = 120;
@@ -89,6 +141,21 @@ namespace {
   int16_t _scrollOffset = 0;
   int16_t _scrollWidth = 0;
   unsigned long _lastScrollTick = 0;
+  bool _framePending = false;
+
+  /**
+   * Envoie le tampon de l'écran.  Si l'image précédente est encore en
+   * file, l'envoi est reporté à OledPin::loop() : le tampon U8g2 garde
+   * toujours la dernière image dessinée, rien n'est perdu.
+   */
+  void sendFrame() {
+    if (!I2CManager::idle()) {
+      _framePending = true;
+      return;
+    }
+    _framePending = false;
+    _oled.sendBuffer();
+  }
 
   void rebuildScrollText() {
     _scrollText = "";
@@ -135,7 +202,7 @@ namespace {
 
       drawLabelValue(60, "etat du test", _testStatusLine);
 
-      _oled.sendBuffer();
+      sendFrame();
       _statusDirty = false;
       return;
     }
@@ -165,18 +232,20 @@ namespace {
       _oled.drawStr(0, baseline, "Logs: OK");
     }
 
-    _oled.sendBuffer();
+    sendFrame();
     _statusDirty = false;
   }
 }
 
 void OledPin::begin() {
-  // Assure que le bus I2C est initialisé sur les broches attendues par le
-  // câblage fourni (SDA=12, SCL=14). Sans cette étape, l'écran reste muet car
-  // l'ESP8266 démarre le bus sur ses broches par défaut (D2/D1).
-  Wire.begin(/*sda=*/12, /*scl=*/14);
+  // Le bus I2C doit avoir été démarré par I2CManager::begin() sur les
+  // broches du câblage (SDA=12, SCL=14) : sans cela l'écran reste muet
+  // car l'ESP8266 démarre le bus sur ses broches par défaut (D2/D1).
   _oled.begin();
   _oled.setPowerSave(0);
+  // Séquence d'initialisation envoyée immédiatement au démarrage
+  I2CManager::flush();
+  _framePending = false;
   _statusActive = false;
   _statusDirty = false;
   _errorMessages.clear();
@@ -227,6 +296,10 @@ void OledPin::showStatus(const String& wifi,
 }
 
 void OledPin::loop() {
+  if (_framePending && I2CManager::idle()) {
+    _framePending = false;
+    _oled.sendBuffer();
+  }
   if (!_statusActive) {
     return;
   }
@@ -286,7 +359,7 @@ void OledPin::showPIN(int pin) {
   _oled.drawStr(84, 36, sessionDigits.c_str());
   _oled.drawStr(0, 54, "Serveur :");
   _oled.drawStr(84, 54, expectedDigits.c_str());
-  _oled.sendBuffer();
+  sendFrame();
 }
 
 void OledPin::setSessionPin(int pin) {
@@ -384,7 +457,7 @@ void OledPin::setTestStatus(const String& status) {
   }
 }
 
-void OledPin::showIOValues(const std::vector<IOBase*>& ios) {
+void OledPin::showIOValues(const std::vector<IOBase*>& ios, const IOSnapshot& snapshot) {
   _statusActive = false;
   _oled.clearBuffer();
   _oled.setFont(u8g2_font_6x12_tf);
@@ -401,11 +474,11 @@ void OledPin::showIOValues(const std::vector<IOBase*>& ios) {
       IOBase* io = ios[i];
       if (!io) continue;
       char line[32];
-      float value = io->readRaw();
+      float value = i < snapshot.codes.size() ? snapshot.codes[i] * io->rawScale() : 0.0f;
       snprintf(line, sizeof(line), "%s:%0.3f", io->id().c_str(), value);
       _oled.drawStr(0, y, line);
       y += 14;
     }
   }
-  _oled.sendBuffer();
+  sendFrame();
 }
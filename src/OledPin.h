@@ -10,6 +10,7 @@
 #include <vector>
 
 class IOBase;
+struct IOSnapshot;
 
 namespace OledPin {
   /** Initialise l'écran OLED (SSD1306 128x64 I2C). */
@@ -35,6 +36,6 @@ namespace OledPin {
   void setSubmittedPin(const String& pin);
   /** Affiche le résultat du test de connexion. */
   void setTestStatus(const String& status);
-  /** Affiche un aperçu des IO après authentification. */
-  void showIOValues(const std::vector<IOBase*>& ios);
+  /** Affiche un aperçu des IO (valeurs de l'instantané) après authentification. */
+  void showIOValues(const std::vector<IOBase*>& ios, const IOSnapshot& snapshot);
 }
@@ -0,0 +1,141 @@
+/**
+ * @file A0Burst.cpp
+ * @brief Implémentation de la capture en rafale de l'ADC interne A0.
+ */
+
+#include "A0Burst.h"
+
+#ifdef ARDUINO_ARCH_ESP8266
+extern "C" {
+#include <user_interface.h>
+}
+
+static SystemA0 _systemA0;
+A0Adc* A0Adc::_active = &_systemA0;
+
+uint16_t SystemA0::read() {
+  return system_adc_read();
+}
+
+bool SystemA0::readFast(uint16_t* out, uint16_t count, uint8_t clkDiv,
+                        uint32_t& startUs, uint32_t& durationUs) {
+  // Le SDK impose la radio coupée et les interruptions masquées
+  // pendant system_adc_read_fast().  Seules les conversions sont
+  // chronométrées : les changements de mode WiFi durent bien plus.
+  uint8_t mode = wifi_get_opmode();
+  wifi_set_opmode_current(NULL_MODE);
+  noInterrupts();
+  startUs = micros();
+  system_adc_read_fast(out, count, clkDiv);
+  durationUs = micros() - startUs;
+  interrupts();
+  wifi_set_opmode_current(mode);
+  return true;
+}
+#else
+// Sur PC, sans convertisseur installé : SimA0 sans signal (codes nuls)
+static SimA0 _defaultA0;
+A0Adc* A0Adc::_active = &_defaultA0;
+#endif
+
+A0Adc& A0Adc::active() {
+  return *_active;
+}
+
+void A0Adc::setActive(A0Adc* adc) {
+#ifdef ARDUINO_ARCH_ESP8266
+  _active = adc ? adc : &_systemA0;
+#else
+  _active = adc ? adc : &_defaultA0;
+#endif
+}
+
+uint32_t SimA0::nowUs() {
+  // Chaque interrogation de l'horloge coûte une microseconde : une
+  // attente active progresse donc comme sur le matériel.
+  return _now++;
+}
+
+uint16_t SimA0::sample(uint32_t tUs) const {
+  float v = _signal ? _signal(tUs) : 0.0f;
+  if (v < 0.0f) v = 0.0f;
+  if (v > 1.0f) v = 1.0f;
+  return static_cast<uint16_t>(v * 1023.0f + 0.5f);
+}
+
+uint16_t SimA0::read() {
+  uint16_t code = sample(_now);
+  _now += _readCostUs;
+  _reads++;
+  return code;
+}
+
+bool SimA0::readFast(uint16_t* out, uint16_t count, uint8_t clkDiv,
+                     uint32_t& startUs, uint32_t& durationUs) {
+  (void)clkDiv;
+  if (!_fastSupported) return false;
+  _now += _modeSwitchUs;
+  startUs = _now;
+  for (uint16_t i = 0; i < count; ++i) {
+    out[i] = sample(_now);
+    _now += _fastIntervalUs;
+  }
+  durationUs = _now - startUs;
+  _now += _modeSwitchUs;
+  _fastBursts++;
+  return true;
+}
+
+// Durée maximale d'une rafale cadencée : au-delà, la boucle principale
+// (WiFi, chien de garde) serait bloquée trop longtemps.
+static const uint32_t MAX_BURST_US = 200000UL;
+
+bool A0Burst::capture(A0Adc& adc, int16_t* out, uint16_t count, uint32_t rateHz,
+                      bool fast, BurstInfo& info) {
+  info = BurstInfo();
+  info.requestedRateHz = rateHz;
+  if (!out || count == 0) return false;
+
+  if (fast) {
+    // Les codes 10 bits tiennent dans un int16_t : lecture sur place.
+    uint16_t* codes = reinterpret_cast<uint16_t*>(out);
+    uint32_t start = 0;
+    uint32_t duration = 0;
+    if (adc.readFast(codes, count, DEFAULT_CLK_DIV, start, duration)) {
+      info.fast = true;
+      info.tStartUs = start;
+      info.durationUs = duration;
+      info.count = count;
+      info.intervalUs = static_cast<float>(info.durationUs) / count;
+      return true;
+    }
+  }
+
+  // Mode cadencé : chaque lecture attend son échéance t0 + i × période
+  // (calculée sans cumul d'erreur).  Une cadence trop basse pour le
+  // nombre d'échantillons est relevée pour borner la durée.
+  if (rateHz > 0) {
+    uint32_t minRate = static_cast<uint32_t>(
+        (static_cast<uint64_t>(count) * 1000000ULL + MAX_BURST_US - 1) / MAX_BURST_US);
+    if (rateHz < minRate) rateHz = minRate;
+  }
+  uint32_t t0 = adc.nowUs();
+  uint32_t first = t0;
+  uint32_t last = t0;
+  for (uint16_t i = 0; i < count; ++i) {
+    if (rateHz > 0) {
+      uint32_t due = t0 + static_cast<uint32_t>(static_cast<uint64_t>(i) * 1000000ULL / rateHz);
+      while (static_cast<int32_t>(adc.nowUs() - due) < 0) {
+      }
+    }
+    uint32_t t = adc.nowUs();
+    if (i == 0) first = t;
+    last = t;
+    out[i] = static_cast<int16_t>(adc.read());
+  }
+  info.tStartUs = first;
+  info.durationUs = adc.nowUs() - first;
+  info.count = count;
+  info.intervalUs = count > 1 ? static_cast<float>(last - first) / (count - 1) : 0.0f;
+  return true;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file A0Burst.h
+ * @brief Capture en rafale de l'ADC interne A0.
+ *
+ * Le moteur d'acquisition lit A0 à la cadence de base (quelques
+ * centaines de Hz).  Pour observer des signaux plus rapides,
+ * l'oscilloscope peut remplir son tampon en une seule rafale :
+ * - mode cadencé : lectures system_adc_read() espacées d'un
+ *   intervalle fixe, WiFi actif (environ 10 kSPS au mieux) ;
+ * - mode rapide : system_adc_read_fast() du SDK, WiFi suspendu et
+ *   interruptions masquées pendant la rafale (plusieurs dizaines de
+ *   kSPS).  Les clients WiFi doivent se réassocier ensuite ; ce mode
+ *   n'est donc utilisé que s'il est demandé explicitement.
+ *
+ * Dans les deux cas l'intervalle réellement obtenu est mesuré et
+ * rapporté dans BurstInfo.  L'accès au convertisseur passe par
+ * l'interface A0Adc, remplacée sur PC par SimA0 (voir setActive()).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/** Métadonnées d'une capture en rafale. */
+struct BurstInfo {
+  uint32_t tStartUs = 0;          ///< Instant de la première lecture
+  uint32_t durationUs = 0;        ///< Durée totale de la rafale
+  uint32_t requestedRateHz = 0;   ///< Cadence demandée (0 = au plus vite)
+  float intervalUs = 0.0f;        ///< Intervalle moyen réellement obtenu
+  uint16_t count = 0;             ///< Nombre d'échantillons capturés
+  bool fast = false;              ///< Capture par system_adc_read_fast()
+};
+
+/** Accès au convertisseur A0 utilisé par les rafales. */
+class A0Adc {
+public:
+  virtual ~A0Adc() {}
+  /** Horloge microseconde de référence des lectures. */
+  virtual uint32_t nowUs() = 0;
+  /** Lecture unique (code 10 bits). */
+  virtual uint16_t read() = 0;
+  /**
+   * Rafale au débit maximal, WiFi suspendu.  `startUs` et `durationUs`
+   * encadrent les seules conversions, sans la coupure et le
+   * rétablissement du WiFi.  Retourne false si ce mode n'est pas
+   * disponible.
+   */
+  virtual bool readFast(uint16_t* out, uint16_t count, uint8_t clkDiv,
+                        uint32_t& startUs, uint32_t& durationUs) {
+    (void)out; (void)count; (void)clkDiv; (void)startUs; (void)durationUs;
+    return false;
+  }
+
+  /** Convertisseur utilisé par les captures (matériel par défaut). */
+  static A0Adc& active();
+  /**
+   * Remplace le convertisseur (nullptr pour revenir au matériel, ou
+   * sur PC à un SimA0 sans signal).
+   */
+  static void setActive(A0Adc* adc);
+
+private:
+  static A0Adc* _active;
+};
+
+#ifdef ARDUINO_ARCH_ESP8266
+/** Convertisseur A0 de l'ESP8266 (SDK). */
+class SystemA0 : public A0Adc {
+public:
+  uint32_t nowUs() override { return micros(); }
+  uint16_t read() override;
+  bool readFast(uint16_t* out, uint16_t count, uint8_t clkDiv,
+                uint32_t& startUs, uint32_t& durationUs) override;
+};
+#endif
+
+/**
+ * Convertisseur A0 simulé pour l'exécution sur PC.  Le temps est
+ * virtuel : chaque lecture l'avance de readCostUs(), une rafale rapide
+ * de fastIntervalUs() par échantillon, plus modeSwitchUs() avant et
+ * après pour la coupure du WiFi.  La tension lue est fournie par
+ * une fonction du temps.
+ */
+class SimA0 : public A0Adc {
+public:
+  typedef float (*SignalFn)(uint32_t tUs);
+
+  /** Fixe la tension vue par l'ADC (0..1 V pleine échelle). */
+  void setSignal(SignalFn fn) { _signal = fn; }
+  void setReadCostUs(uint32_t us) { _readCostUs = us; }
+  void setFastIntervalUs(uint32_t us) { _fastIntervalUs = us; }
+  void setFastSupported(bool on) { _fastSupported = on; }
+  /** Durée simulée de chaque changement de mode WiFi d'une rafale rapide. */
+  void setModeSwitchUs(uint32_t us) { _modeSwitchUs = us; }
+  /** Avance le temps virtuel (attente active de l'appelant). */
+  void advance(uint32_t us) { _now += us; }
+
+  uint32_t nowUs() override;
+  uint16_t read() override;
+  bool readFast(uint16_t* out, uint16_t count, uint8_t clkDiv,
+                uint32_t& startUs, uint32_t& durationUs) override;
+
+  uint32_t reads() const { return _reads; }
+  uint32_t fastBursts() const { return _fastBursts; }
+
+private:
+  SignalFn _signal = nullptr;
+  uint32_t _now = 0;
+  uint32_t _readCostUs = 70;
+  uint32_t _fastIntervalUs = 10;
+  uint32_t _modeSwitchUs = 1000;
+  bool _fastSupported = true;
+  uint32_t _reads = 0;
+  uint32_t _fastBursts = 0;
+  uint16_t sample(uint32_t tUs) const;
+};
+
+class A0Burst {
+public:
+  /** Diviseur d'horloge par défaut de system_adc_read_fast(). */
+  static const uint8_t DEFAULT_CLK_DIV = 8;
+
+  /**
+   * Remplit `out` de `count` codes lus sur A0.  `rateHz` fixe la
+   * cadence du mode cadencé (0 = au plus vite) ; `fast` demande le
+   * mode rapide, qui ignore la cadence et bascule sur le mode cadencé
+   * s'il n'est pas disponible.  Bloque pendant toute la rafale.
+   */
+  static bool capture(A0Adc& adc, int16_t* out, uint16_t count, uint32_t rateHz,
+                      bool fast, BurstInfo& info);
+};
@@ -0,0 +1,230 @@
+/**
+ * @file Acquisition.cpp
+ * @brief Implémentation du moteur d'acquisition cadencé.
+ */
+
+#include "Acquisition.h"
+#include "ConfigStore.h"
+#include "Logger.h"
+#include "Trace.h"
+
+std::vector<Acquisition::Channel*> Acquisition::_channels;
+std::vector<int16_t> Acquisition::_channelOf;
+std::vector<int16_t> Acquisition::_replayChannel;
+SystemClock Acquisition::_systemClock;
+AcqClock* Acquisition::_clock = &Acquisition::_systemClock;
+uint32_t Acquisition::_rateHz = 500;
+uint32_t Acquisition::_periodUs = 2000;
+uint32_t Acquisition::_nextTickUs = 0;
+uint32_t Acquisition::_ticks = 0;
+
+void Acquisition::begin() {
+  for (auto ch : _channels) {
+    delete ch;
+  }
+  _channels.clear();
+
+  auto& doc = ConfigStore::doc("io");
+  uint32_t rate = doc["acquisition"]["rate_hz"] | 500;
+  if (rate < 1) rate = 1;
+  if (rate > 10000) rate = 10000;
+  _rateHz = rate;
+  _periodUs = 1000000UL / _rateHz;
+
+  JsonArray devices = doc["devices"].as<JsonArray>();
+  const std::vector<IOBase*>& ios = IORegistry::list();
+  _channelOf.assign(ios.size(), -1);
+  for (size_t handle = 0; handle < ios.size(); ++handle) {
+    IOBase* io = ios[handle];
+    if (!io->isInput()) continue;
+    uint32_t chRate = _rateHz;
+    for (JsonObject dev : devices) {
+      if (io->id() == dev["id"].as<const char*>()) {
+        chRate = dev["rate_hz"] | _rateHz;
+        break;
+      }
+    }
+    if (chRate < 1) chRate = 1;
+    uint32_t divider = (_rateHz + chRate / 2) / chRate;
+    if (divider < 1) divider = 1;
+
+    Channel* ch = new Channel();
+    ch->io = io;
+    ch->handle = static_cast<IOHandle>(handle);
+    ch->divider = divider;
+    ch->countdown = 1;
+    ch->due = false;
+    ch->pending = false;
+    ch->dueUs = 0;
+    ch->produced = 0;
+    ch->overruns = 0;
+    ch->dropped = 0;
+    ch->failed = 0;
+    ch->windowStart = _clock->nowUs();
+    ch->windowCount = 0;
+    ch->sps = 0.0f;
+    _channelOf[handle] = static_cast<int16_t>(_channels.size());
+    _channels.push_back(ch);
+    Logger::info("ACQ", "begin", String("Channel ") + io->id() + " @ " + (_rateHz / divider) + " Hz");
+  }
+  _replayChannel.clear();
+  if (TracePlayer::active()) {
+    for (const auto& tc : TracePlayer::channels()) {
+      _replayChannel.push_back(static_cast<int16_t>(channelOf(IORegistry::resolve(tc.id))));
+    }
+  }
+  _ticks = 0;
+  _nextTickUs = _clock->nowUs();
+}
+
+void Acquisition::setClock(AcqClock* clock) {
+  _clock = clock ? clock : &_systemClock;
+  uint32_t now = _clock->nowUs();
+  _nextTickUs = now;
+  for (auto ch : _channels) {
+    ch->windowStart = now;
+    ch->windowCount = 0;
+  }
+}
+
+void Acquisition::loop() {
+  if (_channels.empty()) return;
+  uint32_t now = _clock->nowUs();
+  if (TracePlayer::active()) {
+    replay(now);
+    return;
+  }
+  int32_t late = static_cast<int32_t>(now - _nextTickUs);
+  if (late >= 0) {
+    // Nombre de ticks de base écoulés depuis la dernière échéance.  Au-delà
+    // d'un tick, la boucle principale a été bloquée et les échéances
+    // intermédiaires sont perdues.
+    uint32_t ticks = static_cast<uint32_t>(late) / _periodUs + 1;
+    _nextTickUs += ticks * _periodUs;
+    _ticks += ticks;
+
+    for (auto ch : _channels) {
+      if (ch->countdown > ticks) {
+        ch->countdown -= ticks;
+        continue;
+      }
+      uint32_t over = ticks - ch->countdown;
+      ch->overruns += over / ch->divider;
+      ch->countdown = ch->divider - (over % ch->divider);
+      if (ch->due || ch->pending) {
+        // La conversion précédente n'est pas terminée : échéance perdue.
+        ch->overruns++;
+        continue;
+      }
+      ch->due = true;
+      ch->dueUs = now;
+    }
+  }
+
+  // Démarre les conversions arrivées à échéance puis récupère celles
+  // qui sont prêtes ; aucun appel ne bloque sur le convertisseur.
+  bool published = false;
+  for (auto ch : _channels) {
+    if (!ch->io->online()) {
+      // Composant hors ligne : aucune conversion, aucun accès au bus
+      ch->due = false;
+      ch->pending = false;
+      continue;
+    }
+    if (ch->due && ch->io->startConversion()) {
+      ch->due = false;
+      ch->pending = true;
+    }
+    if (!ch->pending) continue;
+    Sample s;
+    IOBase::Collect state = ch->io->collect(s.code);
+    if (state == IOBase::COLLECT_PENDING) continue;
+    ch->pending = false;
+    if (state == IOBase::COLLECT_FAILED) {
+      // Conversion perdue : l'échéance est comptée, rien n'est publié
+      ch->failed++;
+      continue;
+    }
+    s.code = ch->io->calibrate(s.code);
+    s.tUs = ch->dueUs;
+    deliver(ch, s, now);
+    published = true;
+  }
+  if (published) {
+    IORegistry::commitSnapshot(now);
+  }
+}
+
+void Acquisition::deliver(Channel* ch, const Sample& s, uint32_t now) {
+  ch->ring.push(s);
+  IORegistry::publish(ch->handle, s.code, s.tUs);
+  TraceRecorder::record(ch->handle, s.tUs, s.code);
+  ch->produced++;
+  ch->windowCount++;
+
+  uint32_t elapsed = now - ch->windowStart;
+  if (elapsed >= SPS_WINDOW_US) {
+    ch->sps = ch->windowCount * 1000000.0f / elapsed;
+    ch->windowCount = 0;
+    ch->windowStart = now;
+  }
+}
+
+void Acquisition::replay(uint32_t now) {
+  // Les échantillons gardent leur horodatage d'origine
+  bool published = false;
+  TraceRecord r;
+  while (TracePlayer::due(now, r)) {
+    int idx = r.channel < _replayChannel.size() ? _replayChannel[r.channel] : -1;
+    if (idx < 0) continue;
+    Sample s;
+    s.tUs = r.tUs;
+    s.code = r.code;
+    deliver(_channels[idx], s, now);
+    published = true;
+  }
+  if (published) {
+    IORegistry::commitSnapshot(now);
+  }
+}
+
+bool Acquisition::attach(IOHandle io, Reader& reader) {
+  reader.channel = channelOf(io);
+  if (reader.channel < 0) return false;
+  _channels[reader.channel]->ring.attach(reader.cursor);
+  return true;
+}
+
+size_t Acquisition::read(Reader& reader, Sample* out, size_t max) {
+  if (reader.channel < 0 || reader.channel >= static_cast<int>(_channels.size())) {
+    return 0;
+  }
+  Channel* ch = _channels[reader.channel];
+  uint32_t droppedBefore = reader.cursor.dropped;
+  size_t n = ch->ring.read(reader.cursor, out, max);
+  ch->dropped += reader.cursor.dropped - droppedBefore;
+  return n;
+}
+
+bool Acquisition::latest(IOHandle io, Sample& out) {
+  int idx = channelOf(io);
+  if (idx < 0) return false;
+  return _channels[idx]->ring.latest(out);
+}
+
+void Acquisition::stats(JsonObject& out) {
+  out["rate_hz"] = _rateHz;
+  out["ticks"] = _ticks;
+  JsonArray arr = out["channels"].to<JsonArray>();
+  for (auto ch : _channels) {
+    JsonObject o = arr.add<JsonObject>();
+    o["id"] = ch->io->id();
+    o["rate_hz"] = _rateHz / ch->divider;
+    o["online"] = ch->io->online();
+    o["sps"] = ch->sps;
+    o["samples"] = ch->produced;
+    o["overruns"] = ch->overruns;
+    o["dropped"] = ch->dropped;
+    o["failed"] = ch->failed;
+  }
+}
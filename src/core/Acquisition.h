@@ -0,0 +1,143 @@
+/**
+ * @file Acquisition.h
+ * @brief Moteur d'acquisition cadencé des entrées de l'IORegistry.
+ *
+ * Le moteur échantillonne chaque IO d'entrée à une cadence fixe,
+ * indépendamment des autres tâches de la boucle principale (WiFi,
+ * OLED, LittleFS).  Les échantillons horodatés sont écrits dans un
+ * anneau sans verrou par canal ; le multimètre, l'oscilloscope,
+ * l'émetteur UDP et l'API web y lisent chacun avec leur propre
+ * curseur au lieu d'interroger directement le matériel.  Chaque
+ * échantillon est aussi publié dans l'instantané de l'IORegistry.
+ *
+ * Chaque échéance démarre une conversion (IOBase::startConversion())
+ * dont le résultat est récupéré lors d'un passage ultérieur
+ * (IOBase::collect()), de sorte qu'un ADC I2C lent ne bloque jamais
+ * la boucle.
+ *
+ * Le timer1 de l'ESP8266 est déjà utilisé par analogWrite() (sortie
+ * 0–10 V) ; la cadence est donc produite par un ordonnanceur à
+ * échéances appelé à chaque tour de loop() et basé sur une horloge
+ * microseconde abstraite.  Une horloge simulée permet de vérifier
+ * la cadence et le comportement en débordement sur un PC.
+ *
+ * Les échantillons peuvent être enregistrés dans une trace, et une
+ * trace rejouée à la place des conversions (voir Trace.h).
+ *
+ * Configuration (section "acquisition" de io.json) :
+ * - rate_hz : cadence de base en Hz (par défaut 500)
+ * Chaque IO peut préciser son propre "rate_hz", arrondi à un
+ * diviseur entier de la cadence de base.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "IORegistry.h"
+#include "SampleRing.h"
+
+/**
+ * Échantillon horodaté produit par le moteur : code natif du
+ * convertisseur, converti en unité physique par IOBase::scale()
+ * seulement au moment de l'affichage.
+ */
+struct Sample {
+  uint32_t tUs;
+  int16_t code;
+};
+
+/** Source de temps microseconde utilisée par l'ordonnanceur. */
+class AcqClock {
+public:
+  virtual ~AcqClock() {}
+  virtual uint32_t nowUs() = 0;
+};
+
+/** Horloge matérielle basée sur micros(). */
+class SystemClock : public AcqClock {
+public:
+  uint32_t nowUs() override { return micros(); }
+};
+
+/** Horloge virtuelle avancée explicitement (tests sur PC, rejeu). */
+class SimClock : public AcqClock {
+public:
+  uint32_t nowUs() override { return _now; }
+  void set(uint32_t us) { _now = us; }
+  void advance(uint32_t us) { _now += us; }
+private:
+  uint32_t _now = 0;
+};
+
+class Acquisition {
+public:
+  static const size_t RING_SIZE = 64;
+  typedef SampleRing<Sample, RING_SIZE> Ring;
+
+  /** Curseur d'un consommateur sur le canal d'une IO. */
+  struct Reader {
+    int channel = -1;
+    RingCursor cursor;
+  };
+
+  /** Crée un canal par IO d'entrée de l'IORegistry (à rappeler après IORegistry::begin()). */
+  static void begin();
+  /** Échantillonne les canaux arrivés à échéance ; à appeler à chaque tour de loop(). */
+  static void loop();
+  /** Remplace l'horloge (nullptr pour revenir à micros()). */
+  static void setClock(AcqClock* clock);
+  /** Associe un lecteur au canal d'une IO ; false si l'IO n'est pas échantillonnée. */
+  static bool attach(IOHandle io, Reader& reader);
+  /** Lit les nouveaux échantillons d'un lecteur, au plus `max`. */
+  static size_t read(Reader& reader, Sample* out, size_t max);
+  /** Dernier échantillon d'une IO ; false si aucun. */
+  static bool latest(IOHandle io, Sample& out);
+  /** Cadence de base configurée en Hz. */
+  static uint32_t baseRateHz() { return _rateHz; }
+  /** Cadence nominale du canal d'une IO en Hz ; 0 si elle n'est pas échantillonnée. */
+  static uint32_t rateHz(IOHandle io) {
+    int idx = channelOf(io);
+    return idx < 0 ? 0 : _rateHz / _channels[idx]->divider;
+  }
+  /** Statistiques par canal (cadence obtenue, pertes) pour l'API REST. */
+  static void stats(JsonObject& out);
+
+private:
+  struct Channel {
+    IOBase* io;
+    IOHandle handle;
+    uint32_t divider;     ///< Nombre de ticks de base entre deux échantillons
+    uint32_t countdown;   ///< Ticks restant avant la prochaine échéance
+    bool due;             ///< Échéance atteinte, conversion à démarrer
+    bool pending;         ///< Conversion démarrée, résultat à récupérer
+    uint32_t dueUs;       ///< Horodatage de l'échéance en cours
+    Ring ring;
+    uint32_t produced;    ///< Échantillons produits depuis begin()
+    uint32_t overruns;    ///< Échéances manquées (boucle trop lente)
+    uint32_t dropped;     ///< Échantillons écrasés avant lecture par un consommateur
+    uint32_t failed;      ///< Conversions perdues (erreur de bus), non publiées
+    uint32_t windowStart; ///< Début de la fenêtre de mesure de cadence
+    uint32_t windowCount;
+    float sps;            ///< Cadence effective mesurée
+  };
+  static const uint32_t SPS_WINDOW_US = 1000000UL;
+  static std::vector<Channel*> _channels;
+  static std::vector<int16_t> _channelOf;   ///< Canal de chaque handle (-1 si aucun)
+  static std::vector<int16_t> _replayChannel; ///< Canal de chaque canal de la trace rejouée
+  static SystemClock _systemClock;
+  static AcqClock* _clock;
+  static uint32_t _rateHz;
+  static uint32_t _periodUs;
+  static uint32_t _nextTickUs;
+  static uint32_t _ticks;
+  static int channelOf(IOHandle io) {
+    return io < _channelOf.size() ? _channelOf[io] : -1;
+  }
+  /** Publie un échantillon d'un canal (anneau, instantané, trace, cadence). */
+  static void deliver(Channel* ch, const Sample& s, uint32_t now);
+  /** Pousse les échantillons de la trace rejouée arrivés à échéance. */
+  static void replay(uint32_t now);
+};
@@ -0,0 +1,112 @@
+/**
+ * @file Ads1115.cpp
+ * @brief Implémentation du pilote ADS1115 non bloquant.
+ */
+
+#include "Ads1115.h"
+#include "I2CBus.h"
+
+namespace {
+  const uint16_t kDataRates[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+  const float kFullScales[6] = {6.144f, 4.096f, 2.048f, 1.024f, 0.512f, 0.256f};
+}
+
+bool Ads1115::begin() {
+  uint16_t cfg;
+  _configValid = false;
+  _busy = false;
+  return I2CBus::active().readReg16(_address, REG_CONFIG, cfg);
+}
+
+void Ads1115::setDataRate(uint16_t sps) {
+  uint8_t idx = 7;
+  for (uint8_t i = 0; i < 8; ++i) {
+    if (kDataRates[i] >= sps) {
+      idx = i;
+      break;
+    }
+  }
+  if (idx != _drIndex) {
+    _drIndex = idx;
+    _configValid = false;
+  }
+}
+
+uint16_t Ads1115::dataRate() const {
+  return kDataRates[_drIndex];
+}
+
+uint16_t Ads1115::pgaBits(float pga) {
+  // Gain le plus élevé dont la pleine échelle couvre `pga`
+  for (uint16_t i = 5; i > 0; --i) {
+    if (pga <= kFullScales[i]) return i;
+  }
+  return 0;
+}
+
+float Ads1115::fullScale(float pga) {
+  return kFullScales[pgaBits(pga)];
+}
+
+bool Ads1115::start(uint8_t channel, float pga, bool continuous) {
+  uint16_t config = ((0x4 | (channel & 0x3)) << CFG_MUX_SHIFT) |
+                    (pgaBits(pga) << CFG_PGA_SHIFT) |
+                    (static_cast<uint16_t>(_drIndex) << CFG_DR_SHIFT) |
+                    CFG_COMP_OFF;
+  if (!continuous) config |= CFG_MODE_SINGLE;
+
+  if (continuous && _configValid && config == _config) {
+    // Le composant convertit déjà ce canal : on attend le prochain résultat.
+    _busy = true;
+    _configSkipped++;
+    return true;
+  }
+  if (_busy) return false;
+
+  uint16_t word = continuous ? config : (config | CFG_OS);
+  if (!I2CBus::active().writeReg16(_address, REG_CONFIG, word)) {
+    _configValid = false;
+    return false;
+  }
+  _configWrites++;
+  _config = config;
+  _configValid = true;
+  _busy = true;
+  _fresh = true;
+  _startUs = micros();
+  return true;
+}
+
+bool Ads1115::ready() {
+  if (!_busy) return false;
+  uint32_t period = periodUs();
+  // L'oscillateur interne est précis à ±10 % : on garde une marge sur
+  // le premier résultat qui suit une écriture de configuration.
+  uint32_t wait = _fresh ? period + period / 10 : period;
+  if (micros() - _startUs < wait) return false;
+  if (_config & CFG_MODE_SINGLE) {
+    // Le bit OS repasse à 1 à la fin de la conversion single-shot.
+    // En cas d'erreur I2C, read() échouera à son tour et libérera le
+    // composant plutôt que de le laisser bloqué.
+    uint16_t cfg;
+    if (!I2CBus::active().readReg16(_address, REG_CONFIG, cfg)) return true;
+    return (cfg & CFG_OS) != 0;
+  }
+  return true;
+}
+
+bool Ads1115::read(int16_t& code) {
+  uint16_t value;
+  bool ok = I2CBus::active().readReg16(_address, REG_CONVERSION, value);
+  _busy = false;
+  if (!(_config & CFG_MODE_SINGLE)) {
+    // En continu, le résultat suivant arrive une période plus tard.
+    uint32_t now = micros();
+    _startUs = _fresh ? now : _startUs + periodUs();
+    if (now - _startUs > periodUs()) _startUs = now;
+    _fresh = false;
+  }
+  if (!ok) return false;
+  code = static_cast<int16_t>(value);
+  return true;
+}
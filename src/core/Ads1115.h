@@ -0,0 +1,82 @@
+/**
+ * @file Ads1115.h
+ * @brief Pilote registre de l'ADC I2C ADS1115, sans attente active.
+ *
+ * Contrairement au mode single-shot de la bibliothèque Adafruit qui
+ * attend la fin de chaque conversion, ce pilote sépare le lancement
+ * (start) de la récupération (ready/read).  Deux modes sont gérés :
+ * - single-shot : chaque start() écrit la configuration avec le bit
+ *   OS ; ready() n'interroge le composant qu'une fois la durée de
+ *   conversion écoulée ;
+ * - continu : le composant convertit en permanence au débit choisi
+ *   (8 à 860 SPS) ; la configuration n'est réécrite que si le canal
+ *   ou le gain changent et le registre de conversion n'est lu que
+ *   lorsqu'un nouveau résultat est disponible.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Ads1115 {
+public:
+  // Registres du composant
+  static const uint8_t REG_CONVERSION = 0x00;
+  static const uint8_t REG_CONFIG     = 0x01;
+  static const uint8_t REG_LO_THRESH  = 0x02;
+  static const uint8_t REG_HI_THRESH  = 0x03;
+
+  // Champs du registre de configuration
+  static const uint16_t CFG_OS          = 0x8000;
+  static const uint16_t CFG_MUX_SHIFT   = 12;
+  static const uint16_t CFG_PGA_SHIFT   = 9;
+  static const uint16_t CFG_MODE_SINGLE = 0x0100;
+  static const uint16_t CFG_DR_SHIFT    = 5;
+  static const uint16_t CFG_COMP_OFF    = 0x0003;
+
+  explicit Ads1115(uint8_t address) : _address(address) {}
+
+  uint8_t address() const { return _address; }
+  /** Vérifie la présence du composant en lisant sa configuration. */
+  bool begin();
+  /** Fixe le débit de conversion (arrondi au débit supporté supérieur). */
+  void setDataRate(uint16_t sps);
+  /** Débit de conversion effectif en SPS. */
+  uint16_t dataRate() const;
+  /** Durée nominale d'une conversion en µs. */
+  uint32_t periodUs() const { return 1000000UL / dataRate(); }
+
+  /**
+   * Lance une conversion sur une entrée single-ended.  Retourne false
+   * si un résultat précédent n'a pas encore été lu ou en cas d'erreur
+   * I2C.  En mode continu, aucune écriture n'a lieu si le canal et le
+   * gain sont déjà configurés.
+   */
+  bool start(uint8_t channel, float pga, bool continuous);
+  /** Indique si le résultat de la conversion lancée est disponible. */
+  bool ready();
+  /** Lit le résultat de la conversion lancée et libère le composant. */
+  bool read(int16_t& code);
+  /** true entre start() et read(). */
+  bool busy() const { return _busy; }
+  /** Nombre d'écritures du registre de configuration. */
+  uint32_t configWrites() const { return _configWrites; }
+  /** Nombre de démarrages servis sans réécrire la configuration. */
+  uint32_t configSkipped() const { return _configSkipped; }
+
+  /** Code de gain PGA pour une pleine échelle en volts. */
+  static uint16_t pgaBits(float pga);
+  /** Pleine échelle en volts du gain retenu pour `pga`. */
+  static float fullScale(float pga);
+
+private:
+  uint8_t _address;
+  uint8_t _drIndex = 4;       ///< 128 SPS, valeur par défaut du composant
+  uint16_t _config = 0;       ///< Dernière configuration écrite (sans OS)
+  bool _configValid = false;
+  bool _busy = false;
+  bool _fresh = false;        ///< Premier résultat après écriture de la config
+  uint32_t _startUs = 0;      ///< Instant de référence du résultat attendu
+  uint32_t _configWrites = 0;
+  uint32_t _configSkipped = 0;
+};
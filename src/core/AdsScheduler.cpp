@@ -0,0 +1,105 @@
+/**
+ * @file AdsScheduler.cpp
+ * @brief Implémentation de l'ordonnanceur tourniquet ADS1115.
+ */
+
+#include "AdsScheduler.h"
+
+int AdsScheduler::addChannel(uint8_t channel, float pga, bool continuous) {
+  Slot s;
+  s.channel = channel;
+  s.pga = pga;
+  s.continuous = continuous;
+  s.requested = false;
+  s.hasResult = false;
+  s.ok = false;
+  s.code = 0;
+  s.conversions = 0;
+  s.windowStart = micros();
+  s.windowCount = 0;
+  s.sps = 0.0f;
+  _slots.push_back(s);
+  return static_cast<int>(_slots.size()) - 1;
+}
+
+void AdsScheduler::request(int slot) {
+  if (slot < 0 || slot >= static_cast<int>(_slots.size())) return;
+  _slots[slot].requested = true;
+}
+
+bool AdsScheduler::take(int slot, int16_t& code, bool& ok) {
+  if (slot < 0 || slot >= static_cast<int>(_slots.size())) return false;
+  Slot &s = _slots[slot];
+  if (!s.hasResult) return false;
+  s.hasResult = false;
+  code = s.code;
+  ok = s.ok;
+  return true;
+}
+
+void AdsScheduler::service() {
+  if (_current >= 0) {
+    if (!_device->ready()) return;
+    Slot &s = _slots[_current];
+    s.ok = _device->read(s.code);
+    s.hasResult = true;
+    _current = -1;
+    if (!s.ok) {
+      _errors++;
+    } else {
+      _conversions++;
+      s.conversions++;
+      s.windowCount++;
+      uint32_t now = micros();
+      uint32_t elapsed = now - s.windowStart;
+      if (elapsed >= SPS_WINDOW_US) {
+        s.sps = s.windowCount * 1000000.0f / elapsed;
+        s.windowCount = 0;
+        s.windowStart = now;
+      }
+    }
+  }
+
+  // Tourniquet : lance la première demande trouvée après le dernier
+  // emplacement servi, pour qu'aucun canal ne monopolise le composant.
+  size_t n = _slots.size();
+  for (size_t i = 0; i < n; ++i) {
+    size_t idx = (_next + i) % n;
+    Slot &s = _slots[idx];
+    if (!s.requested) continue;
+    s.requested = false;
+    _next = idx + 1;
+    if (_device->start(s.channel, s.pga, s.continuous)) {
+      _current = static_cast<int>(idx);
+    } else {
+      s.ok = false;
+      s.hasResult = true;
+      _errors++;
+    }
+    break;
+  }
+}
+
+void AdsScheduler::reset() {
+  _current = -1;
+  for (auto &s : _slots) {
+    s.requested = false;
+    s.hasResult = false;
+  }
+}
+
+void AdsScheduler::stats(JsonObject& out) const {
+  out["address"] = _device->address();
+  out["data_rate"] = _device->dataRate();
+  out["conversions"] = _conversions;
+  out["errors"] = _errors;
+  out["config_writes"] = _device->configWrites();
+  out["config_skipped"] = _device->configSkipped();
+  JsonArray arr = out["channels"].to<JsonArray>();
+  for (const auto &s : _slots) {
+    JsonObject o = arr.add<JsonObject>();
+    o["channel"] = s.channel;
+    o["conversions"] = s.conversions;
+    o["sps"] = s.sps;
+  }
+}
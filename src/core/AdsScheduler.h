@@ -0,0 +1,65 @@
+/**
+ * @file AdsScheduler.h
+ * @brief Ordonnanceur tourniquet des conversions d'un ADS1115.
+ *
+ * Un ADS1115 ne convertit qu'une entrée à la fois.  Chaque canal
+ * logique (IO_ADS1115) s'inscrit auprès de l'ordonnanceur de son
+ * composant et y dépose ses demandes de conversion.  service() fait
+ * progresser la machine d'état sans jamais attendre : récupération du
+ * résultat en cours s'il est prêt, puis lancement de la demande
+ * suivante dans l'ordre du tourniquet.  Comme le moteur d'acquisition
+ * appelle collect() sur tous les canaux en attente à chaque passage,
+ * les composants situés à des adresses différentes convertissent en
+ * parallèle : le débit global croît avec le nombre de composants.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "Ads1115.h"
+
+class AdsScheduler {
+public:
+  explicit AdsScheduler(Ads1115* device) : _device(device) {}
+  ~AdsScheduler() { delete _device; }
+
+  Ads1115* device() { return _device; }
+
+  /** Inscrit un canal et retourne son numéro d'emplacement. */
+  int addChannel(uint8_t channel, float pga, bool continuous);
+  /** Demande une conversion pour l'emplacement (sans effet si déjà demandée). */
+  void request(int slot);
+  /** Récupère le résultat de l'emplacement s'il est disponible. */
+  bool take(int slot, int16_t& code, bool& ok);
+  /** Fait progresser la machine d'état sans bloquer. */
+  void service();
+  /** Abandonne la conversion en cours et les demandes (composant réinitialisé). */
+  void reset();
+  /** Statistiques du composant et de ses canaux. */
+  void stats(JsonObject& out) const;
+
+private:
+  struct Slot {
+    uint8_t channel;
+    float pga;
+    bool continuous;
+    bool requested;
+    bool hasResult;
+    bool ok;
+    int16_t code;
+    uint32_t conversions;
+    uint32_t windowStart;
+    uint32_t windowCount;
+    float sps;
+  };
+  static const uint32_t SPS_WINDOW_US = 1000000UL;
+  Ads1115* _device;
+  std::vector<Slot> _slots;
+  int _current = -1;   ///< Emplacement dont la conversion est en cours
+  size_t _next = 0;    ///< Prochain emplacement examiné par le tourniquet
+  uint32_t _conversions = 0;
+  uint32_t _errors = 0;
+};
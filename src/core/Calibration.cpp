@@ -0,0 +1,121 @@
+/**
+ * @file Calibration.cpp
+ * @brief Compilation des sections "calibration" de io.json.
+ */
+
+#include "Calibration.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+namespace {
+  struct CalFunction {
+    std::vector<std::pair<float, float>> points;
+    std::vector<float> poly;
+
+    float eval(float x) const {
+      if (!poly.empty()) {
+        float y = 0.0f;
+        for (size_t i = poly.size(); i-- > 0;) y = y * x + poly[i];
+        return y;
+      }
+      // Segment contenant x, ou segment extrême prolongé
+      size_t i = 1;
+      while (i < points.size() - 1 && x > points[i].first) ++i;
+      const auto& a = points[i - 1];
+      const auto& b = points[i];
+      return a.second + (x - a.first) * (b.second - a.second) / (b.first - a.first);
+    }
+  };
+
+  bool parse(JsonVariantConst cfg, CalFunction& fn, String& error) {
+    JsonArrayConst points = cfg["points"].as<JsonArrayConst>();
+    JsonArrayConst poly = cfg["poly"].as<JsonArrayConst>();
+    if (!points.isNull()) {
+      for (JsonArrayConst p : points) {
+        fn.points.push_back({p[0].as<float>(), p[1].as<float>()});
+      }
+      std::sort(fn.points.begin(), fn.points.end());
+      if (fn.points.size() < 2) {
+        error = "at least two points required";
+        return false;
+      }
+      for (size_t i = 1; i < fn.points.size(); ++i) {
+        if (fn.points[i].first == fn.points[i - 1].first) {
+          error = "duplicate point";
+          return false;
+        }
+      }
+      return true;
+    }
+    if (!poly.isNull()) {
+      for (JsonVariantConst c : poly) fn.poly.push_back(c.as<float>());
+      if (fn.poly.empty()) {
+        error = "empty polynomial";
+        return false;
+      }
+      return true;
+    }
+    error = "expected \"points\" or \"poly\"";
+    return false;
+  }
+
+  int16_t toCode(float volts, float voltsPerCode) {
+    float c = roundf(volts / voltsPerCode);
+    if (c > 32767.0f) return 32767;
+    if (c < -32768.0f) return -32768;
+    return static_cast<int16_t>(c);
+  }
+}
+
+CalTable* CalTable::compile(JsonVariantConst cfg, int32_t codeMin, int32_t codeMax,
+                            float voltsPerCode, bool inverse, String& error) {
+  CalFunction fn;
+  if (!parse(cfg, fn, error)) return nullptr;
+  if (codeMax <= codeMin || voltsPerCode == 0.0f) {
+    error = "invalid code range";
+    return nullptr;
+  }
+  float lo = codeMin * voltsPerCode;
+  float hi = codeMax * voltsPerCode;
+  float yLo = fn.eval(lo);
+  float yHi = fn.eval(hi);
+  if (inverse && !(yHi > yLo)) {
+    // L'inversion par dichotomie suppose une sortie croissante
+    error = "output calibration must be increasing";
+    return nullptr;
+  }
+
+  CalTable* t = new CalTable();
+  t->_min = codeMin;
+  t->_span = codeMax - codeMin;
+  while ((static_cast<int32_t>(1) << (SEGMENTS_LOG2 + t->_shift)) < t->_span) t->_shift++;
+  t->_mask = (static_cast<int32_t>(1) << t->_shift) - 1;
+  if (inverse) {
+    t->_outMin = codeMin;
+    t->_outMax = codeMax;
+  }
+  for (uint16_t k = 0; k < NODES; ++k) {
+    float x = (codeMin + (static_cast<int32_t>(k) << t->_shift)) * voltsPerCode;
+    if (!inverse) {
+      t->_table[k] = toCode(fn.eval(x), voltsPerCode);
+      continue;
+    }
+    // Tension nominale donnant x en sortie
+    float a = lo;
+    float b = hi;
+    if (x <= yLo) {
+      b = lo;
+    } else if (x >= yHi) {
+      a = hi;
+    } else {
+      for (int it = 0; it < 32; ++it) {
+        float m = 0.5f * (a + b);
+        if (fn.eval(m) < x) a = m; else b = m;
+      }
+    }
+    t->_table[k] = toCode(0.5f * (a + b), voltsPerCode);
+  }
+  return t;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file Calibration.h
+ * @brief Étalonnage des IO compilé en table entière interpolée.
+ *
+ * Le pont diviseur de A0 et le module PWM→0–10 V ne sont pas
+ * linéaires : un simple facteur code → volts ne suffit pas.  Chaque
+ * IO de io.json peut porter une section "calibration" :
+ * - "points" : couples [x, y] en volts, au moins deux, reliés par
+ *   segments (prolongés linéairement au-delà des extrémités) ;
+ * - "poly" : coefficients [c0, c1, c2...] de y = c0 + c1·x + c2·x²...
+ *
+ * Pour une entrée, x est la tension lue sans correction (code ×
+ * scale()) et y la tension vraie.  Pour une sortie, x est la tension
+ * demandée (nominale) et y la tension mesurée en sortie ; la table
+ * compilée est alors l'inverse, qui donne le code à écrire pour
+ * obtenir la tension voulue.
+ *
+ * À la configuration, la fonction est échantillonnée sur
+ * NODES nœuds régulièrement espacés du domaine des codes.  Sur le
+ * chemin chaud, la correction est un décalage, un accès à deux
+ * entrées et une interpolation entière : code corrigé dans la même
+ * unité que le code brut, si bien que scale() reste inchangé.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class CalTable {
+public:
+  static const uint8_t SEGMENTS_LOG2 = 7;
+  static const uint16_t NODES = (1u << SEGMENTS_LOG2) + 1;
+
+  /**
+   * Compile la section `cfg` pour des codes [codeMin, codeMax] valant
+   * `voltsPerCode` volts chacun.  `inverse` compile la table d'une
+   * sortie.  Retourne nullptr (et renseigne `error`) si la section est
+   * invalide.
+   */
+  static CalTable* compile(JsonVariantConst cfg, int32_t codeMin, int32_t codeMax,
+                           float voltsPerCode, bool inverse, String& error);
+
+  /** Code corrigé, borné au domaine. */
+  int16_t apply(int32_t code) const {
+    int32_t x = code - _min;
+    if (x < 0) x = 0;
+    if (x > _span) x = _span;
+    int32_t i = x >> _shift;
+    int32_t frac = x & _mask;
+    int32_t a = _table[i];
+    int32_t y = frac ? a + (((_table[i + 1] - a) * frac) >> _shift) : a;
+    if (y < _outMin) y = _outMin;
+    if (y > _outMax) y = _outMax;
+    return static_cast<int16_t>(y);
+  }
+
+private:
+  int32_t _min = 0;
+  int32_t _span = 0;       ///< Décalage maximal accepté (codeMax - codeMin)
+  uint8_t _shift = 0;      ///< log2 du nombre de codes par segment
+  int32_t _mask = 0;
+  int32_t _outMin = -32768;
+  int32_t _outMax = 32767;
+  int16_t _table[NODES];
+};
@@ -0,0 +1,137 @@
+/**
+ * @file CaptureRing.h
+ * @brief Tampon circulaire de capture de l'oscilloscope.
+ *
+ * Contrairement à SampleRing, dont la taille est fixée à la
+ * compilation et que chaque consommateur lit avec son curseur, un
+ * CaptureRing conserve les `capacity()` derniers éléments d'un canal
+ * pour qu'un lecteur les parcoure en entier, du plus ancien au plus
+ * récent.  La capacité est une puissance de deux choisie à
+ * l'exécution : l'écriture d'un élément coûte une affectation, un
+ * masque et un incrément, quelle que soit la taille du tampon.
+ *
+ * `seq` compte les éléments écrits depuis reset().  view() en fige la
+ * valeur et expose une vue linéarisée (indexée par masque, sans
+ * copie) ; overwritten() indique ensuite combien de ses premiers
+ * éléments le producteur a pu réécrire pendant la lecture, comme la
+ * vérification de SampleRing::read().
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+template <typename T>
+class CaptureRing {
+public:
+  /** Vue linéarisée : at(0) est l'élément le plus ancien. */
+  struct View {
+    const T* data = nullptr;
+    uint32_t mask = 0;
+    uint32_t start = 0;   ///< Numéro de séquence du premier élément
+    uint32_t count = 0;
+    uint32_t size() const { return count; }
+    const T& at(uint32_t i) const { return data[(start + i) & mask]; }
+    /** Premier segment contigu (du plus ancien à la fin du stockage). */
+    uint32_t firstLength() const {
+      uint32_t offset = start & mask;
+      uint32_t room = mask + 1 - offset;
+      return count < room ? count : room;
+    }
+    const T* first() const { return data + (start & mask); }
+    /** Second segment contigu (début du stockage), éventuellement vide. */
+    uint32_t secondLength() const { return count - firstLength(); }
+    const T* second() const { return data; }
+  };
+
+  CaptureRing() = default;
+  /** Copie à la configuration (canaux stockés par valeur), jamais pendant l'écriture. */
+  CaptureRing(const CaptureRing& other) :
+    _slots(other._slots), _mask(other._mask), _seq(other.seq()) {}
+  CaptureRing& operator=(const CaptureRing& other) {
+    _slots = other._slots;
+    _mask = other._mask;
+    _seq.store(other.seq(), std::memory_order_release);
+    return *this;
+  }
+
+  /** Plus petite puissance de deux supérieure ou égale à `n` (au moins 2). */
+  static size_t roundCapacity(size_t n) {
+    size_t c = 2;
+    while (c < n) c <<= 1;
+    return c;
+  }
+
+  /** Alloue `capacity` éléments, arrondi à une puissance de deux. */
+  void allocate(size_t capacity) {
+    _slots.assign(roundCapacity(capacity), T());
+    _mask = static_cast<uint32_t>(_slots.size() - 1);
+    reset();
+  }
+
+  size_t capacity() const { return _slots.size(); }
+  /** Vide le tampon (à n'appeler qu'en l'absence de lecteur). */
+  void reset() { _seq.store(0, std::memory_order_release); }
+  uint32_t seq() const { return _seq.load(std::memory_order_acquire); }
+  size_t size() const {
+    uint32_t s = seq();
+    return s < _slots.size() ? s : _slots.size();
+  }
+
+  /** Ajoute un élément ; écrase le plus ancien si le tampon est plein. */
+  void push(const T& value) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _slots[s & _mask] = value;
+    _seq.store(s + 1, std::memory_order_release);
+  }
+
+  /**
+   * Stockage brut, pour un remplissage d'un bloc (rafale) : écrire au
+   * plus capacity() éléments à partir de l'indice 0 puis appeler
+   * commitBlock().
+   */
+  T* block() { return _slots.data(); }
+  /** Publie `count` éléments écrits par block() (le contenu précédent est perdu). */
+  void commitBlock(size_t count) {
+    if (count > _slots.size()) count = _slots.size();
+    _seq.store(static_cast<uint32_t>(count), std::memory_order_release);
+  }
+
+  /** Vue des éléments présents, figée à l'appel. */
+  View view() const {
+    View v;
+    uint32_t s = seq();
+    v.data = _slots.data();
+    v.mask = _mask;
+    v.count = s < _slots.size() ? s : static_cast<uint32_t>(_slots.size());
+    v.start = s - v.count;
+    return v;
+  }
+
+  /**
+   * Vue de `count` éléments à partir du numéro de séquence `start`,
+   * sans contrôle : à l'appelant de vérifier qu'ils sont encore présents.
+   */
+  View range(uint32_t start, uint32_t count) const {
+    View v;
+    v.data = _slots.data();
+    v.mask = _mask;
+    v.start = start;
+    v.count = count;
+    return v;
+  }
+
+  /** Nombre des premiers éléments de `v` réécrits depuis view(). */
+  uint32_t overwritten(const View& v) const {
+    uint32_t written = seq() - (v.start + v.count);
+    return written < v.count ? written : v.count;
+  }
+
+private:
+  std::vector<T> _slots;
+  uint32_t _mask = 0;
+  std::atomic<uint32_t> _seq{0};
+};
@@ -0,0 +1,79 @@
+/**
+ * @file DeviceHealth.h
+ * @brief État de santé d'un composant I2C et reprise avec recul exponentiel.
+ *
+ * Chaque composant configuré est sondé une fois par
+ * IORegistry::begin().  Un composant absent, ou qui accumule des
+ * erreurs en fonctionnement, passe hors ligne : ses IO ne sont plus
+ * échantillonnées ni écrites, ce qui ne coûte qu'un test de booléen
+ * par échantillon.  IORegistry::loop() le sonde à nouveau après un
+ * délai qui double à chaque échec (RETRY_MIN_MS à RETRY_MAX_MS).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class DeviceHealth {
+public:
+  static const uint32_t RETRY_MIN_MS = 500;
+  static const uint32_t RETRY_MAX_MS = 60000;
+  /** Erreurs consécutives en fonctionnement avant la mise hors ligne. */
+  static const uint8_t ERRORS_BEFORE_OFFLINE = 5;
+
+  bool online() const { return _online; }
+
+  /** Enregistre le résultat d'une sonde et planifie la suivante en cas d'échec. */
+  void probed(bool ok, uint32_t nowMs) {
+    _probes++;
+    _errorRun = 0;
+    if (ok) {
+      _online = true;
+      _retryDelayMs = RETRY_MIN_MS;
+      return;
+    }
+    _online = false;
+    _probeFailures++;
+    _nextRetryMs = nowMs + _retryDelayMs;
+    _retryDelayMs = _retryDelayMs >= RETRY_MAX_MS / 2 ? RETRY_MAX_MS : _retryDelayMs * 2;
+  }
+  /** Transaction réussie sur le chemin d'acquisition ou d'écriture. */
+  void reportOk() { _errorRun = 0; }
+  /**
+   * Transaction échouée.  Retourne true si le composant vient de
+   * passer hors ligne.
+   */
+  bool reportError(uint32_t nowMs) {
+    _errors++;
+    if (!_online || ++_errorRun < ERRORS_BEFORE_OFFLINE) return false;
+    _online = false;
+    _errorRun = 0;
+    _retryDelayMs = RETRY_MIN_MS;
+    _nextRetryMs = nowMs + RETRY_MIN_MS;
+    return true;
+  }
+  /** true si le composant est hors ligne et que sa prochaine sonde est due. */
+  bool retryDue(uint32_t nowMs) const {
+    return !_online && static_cast<int32_t>(nowMs - _nextRetryMs) >= 0;
+  }
+  void stats(JsonObject& out) const {
+    out["online"] = _online;
+    out["probes"] = _probes;
+    out["probe_failures"] = _probeFailures;
+    out["errors"] = _errors;
+    if (!_online) {
+      int32_t left = static_cast<int32_t>(_nextRetryMs - millis());
+      out["retry_in_ms"] = left > 0 ? left : 0;
+    }
+  }
+
+private:
+  bool _online = false;
+  uint8_t _errorRun = 0;
+  uint32_t _retryDelayMs = RETRY_MIN_MS;
+  uint32_t _nextRetryMs = 0;
+  uint32_t _probes = 0;
+  uint32_t _probeFailures = 0;
+  uint32_t _errors = 0;
+};
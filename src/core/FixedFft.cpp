@@ -0,0 +1,186 @@
+/**
+ * @file FixedFft.cpp
+ * @brief Tables, fenêtres et papillons de la FFT Q15.
+ */
+
+#include "FixedFft.h"
+
+namespace {
+  // sin(2π·m / 2048) en Q15 pour m = 0..512
+  const int16_t kQuarterSine[FixedFft::MAX_SIZE / 4 + 1] PROGMEM = {
+  0, 101, 201, 302, 402, 503, 603, 704, 804, 905, 1005, 1106,
+  1206, 1307, 1407, 1507, 1608, 1708, 1809, 1909, 2009, 2110, 2210, 2310,
+  2410, 2511, 2611, 2711, 2811, 2911, 3012, 3112, 3212, 3312, 3412, 3512,
+  3612, 3712, 3811, 3911, 4011, 4111, 4210, 4310, 4410, 4509, 4609, 4708,
+  4808, 4907, 5007, 5106, 5205, 5305, 5404, 5503, 5602, 5701, 5800, 5899,
+  5998, 6096, 6195, 6294, 6393, 6491, 6590, 6688, 6786, 6885, 6983, 7081,
+  7179, 7277, 7375, 7473, 7571, 7669, 7767, 7864, 7962, 8059, 8157, 8254,
+  8351, 8448, 8545, 8642, 8739, 8836, 8933, 9030, 9126, 9223, 9319, 9416,
+  9512, 9608, 9704, 9800, 9896, 9992, 10087, 10183, 10278, 10374, 10469, 10564,
+  10659, 10754, 10849, 10944, 11039, 11133, 11228, 11322, 11417, 11511, 11605, 11699,
+  11793, 11886, 11980, 12074, 12167, 12260, 12353, 12446, 12539, 12632, 12725, 12817,
+  12910, 13002, 13094, 13187, 13279, 13370, 13462, 13554, 13645, 13736, 13828, 13919,
+  14010, 14101, 14191, 14282, 14372, 14462, 14553, 14643, 14732, 14822, 14912, 15001,
+  15090, 15180, 15269, 15358, 15446, 15535, 15623, 15712, 15800, 15888, 15976, 16063,
+  16151, 16238, 16325, 16413, 16499, 16586, 16673, 16759, 16846, 16932, 17018, 17104,
+  17189, 17275, 17360, 17445, 17530, 17615, 17700, 17784, 17869, 17953, 18037, 18121,
+  18204, 18288, 18371, 18454, 18537, 18620, 18703, 18785, 18868, 18950, 19032, 19113,
+  19195, 19276, 19357, 19438, 19519, 19600, 19680, 19761, 19841, 19921, 20000, 20080,
+  20159, 20238, 20317, 20396, 20475, 20553, 20631, 20709, 20787, 20865, 20942, 21019,
+  21096, 21173, 21250, 21326, 21403, 21479, 21554, 21630, 21705, 21781, 21856, 21930,
+  22005, 22079, 22154, 22227, 22301, 22375, 22448, 22521, 22594, 22667, 22739, 22812,
+  22884, 22956, 23027, 23099, 23170, 23241, 23311, 23382, 23452, 23522, 23592, 23662,
+  23731, 23801, 23870, 23938, 24007, 24075, 24143, 24211, 24279, 24346, 24413, 24480,
+  24547, 24613, 24680, 24746, 24811, 24877, 24942, 25007, 25072, 25137, 25201, 25265,
+  25329, 25393, 25456, 25519, 25582, 25645, 25708, 25770, 25832, 25893, 25955, 26016,
+  26077, 26138, 26198, 26259, 26319, 26378, 26438, 26497, 26556, 26615, 26674, 26732,
+  26790, 26848, 26905, 26962, 27019, 27076, 27133, 27189, 27245, 27300, 27356, 27411,
+  27466, 27521, 27575, 27629, 27683, 27737, 27790, 27843, 27896, 27949, 28001, 28053,
+  28105, 28157, 28208, 28259, 28310, 28360, 28411, 28460, 28510, 28560, 28609, 28658,
+  28706, 28755, 28803, 28850, 28898, 28945, 28992, 29039, 29085, 29131, 29177, 29223,
+  29268, 29313, 29358, 29403, 29447, 29491, 29534, 29578, 29621, 29664, 29706, 29749,
+  29791, 29832, 29874, 29915, 29956, 29997, 30037, 30077, 30117, 30156, 30195, 30234,
+  30273, 30311, 30349, 30387, 30424, 30462, 30498, 30535, 30571, 30607, 30643, 30679,
+  30714, 30749, 30783, 30818, 30852, 30885, 30919, 30952, 30985, 31017, 31050, 31082,
+  31113, 31145, 31176, 31206, 31237, 31267, 31297, 31327, 31356, 31385, 31414, 31442,
+  31470, 31498, 31526, 31553, 31580, 31607, 31633, 31659, 31685, 31710, 31736, 31760,
+  31785, 31809, 31833, 31857, 31880, 31903, 31926, 31949, 31971, 31993, 32014, 32036,
+  32057, 32077, 32098, 32118, 32137, 32157, 32176, 32195, 32213, 32232, 32250, 32267,
+  32285, 32302, 32318, 32335, 32351, 32367, 32382, 32397, 32412, 32427, 32441, 32455,
+  32469, 32482, 32495, 32508, 32521, 32533, 32545, 32556, 32567, 32578, 32589, 32599,
+  32609, 32619, 32628, 32637, 32646, 32655, 32663, 32671, 32678, 32685, 32692, 32699,
+  32705, 32711, 32717, 32722, 32728, 32732, 32737, 32741, 32745, 32748, 32752, 32755,
+  32757, 32759, 32761, 32763, 32765, 32766, 32766, 32767, 32767
+  };
+
+  // log2(1 + i/32) en Q12 pour i = 0..32
+  const uint16_t kLog2[33] PROGMEM = {
+  0, 182, 358, 530, 696, 858, 1016, 1169, 1319, 1465, 1607, 1746,
+  1882, 2015, 2145, 2272, 2396, 2518, 2637, 2754, 2869, 2982, 3092, 3200,
+  3307, 3412, 3514, 3615, 3715, 3812, 3908, 4003, 4096
+  };
+
+  // Coefficients Q15 des sommes de cosinus, signes alternés
+  const int16_t kHann[] = {16384, 16384};
+  const int16_t kFlatTop[] = {7064, 13652, 9085, 2739, 228};
+  const int16_t kBlackmanHarris[] = {11756, 16000, 4629, 383};
+
+  void coefficients(FixedFft::Window w, const int16_t*& a, uint8_t& terms) {
+    switch (w) {
+      case FixedFft::WINDOW_FLATTOP: a = kFlatTop; terms = 5; return;
+      case FixedFft::WINDOW_BLACKMAN_HARRIS: a = kBlackmanHarris; terms = 4; return;
+      default: a = kHann; terms = 2; return;
+    }
+  }
+}
+
+bool FixedFft::parseWindow(const String& name, Window& out) {
+  if (name == "hann") out = WINDOW_HANN;
+  else if (name == "flattop") out = WINDOW_FLATTOP;
+  else if (name == "blackman_harris") out = WINDOW_BLACKMAN_HARRIS;
+  else return false;
+  return true;
+}
+
+const char* FixedFft::windowName(Window w) {
+  static const char* names[] = {"hann", "flattop", "blackman_harris"};
+  return names[w];
+}
+
+bool FixedFft::validSize(uint32_t size) {
+  return size >= MIN_SIZE && size <= MAX_SIZE && (size & (size - 1)) == 0;
+}
+
+int16_t FixedFft::sinQ15(uint32_t m) {
+  const uint32_t quarter = MAX_SIZE / 4;
+  m &= MAX_SIZE - 1;
+  if (m < quarter) return static_cast<int16_t>(pgm_read_word(&kQuarterSine[m]));
+  if (m < 2 * quarter) return static_cast<int16_t>(pgm_read_word(&kQuarterSine[2 * quarter - m]));
+  if (m < 3 * quarter) return -static_cast<int16_t>(pgm_read_word(&kQuarterSine[m - 2 * quarter]));
+  return -static_cast<int16_t>(pgm_read_word(&kQuarterSine[MAX_SIZE - m]));
+}
+
+int16_t FixedFft::sinPhase(uint32_t phase) {
+  // 11 bits d'index, 15 bits de fraction sur les 21 restants
+  uint32_t m = phase >> 21;
+  int32_t frac = static_cast<int32_t>((phase >> 6) & 0x7FFF);
+  int32_t a = sinQ15(m);
+  int32_t b = sinQ15(m + 1);
+  return static_cast<int16_t>(a + (((b - a) * frac + (1 << 14)) >> 15));
+}
+
+int16_t FixedFft::window(Window w, uint16_t n, uint16_t size) {
+  const int16_t* a;
+  uint8_t terms;
+  coefficients(w, a, terms);
+  // a0 − a1·cos(θ) + a2·cos(2θ) − ..., θ = 2πn/size (fenêtre périodique)
+  uint32_t step = static_cast<uint32_t>(n) * (MAX_SIZE / size);
+  int32_t sum = static_cast<int32_t>(a[0]) << 15;
+  for (uint8_t k = 1; k < terms; ++k) {
+    int32_t term = static_cast<int32_t>(a[k]) * cosQ15(step * k);
+    sum += (k & 1) ? -term : term;
+  }
+  sum = (sum + (1 << 14)) >> 15;
+  // La flat-top descend légèrement sous zéro aux bords
+  if (sum > 32767) sum = 32767;
+  return static_cast<int16_t>(sum);
+}
+
+int16_t FixedFft::coherentGain(Window w) {
+  const int16_t* a;
+  uint8_t terms;
+  coefficients(w, a, terms);
+  return a[0];
+}
+
+void FixedFft::transform(int16_t* re, int16_t* im, uint16_t size) {
+  // Permutation par inversion des bits
+  for (uint16_t i = 1, j = 0; i < size; ++i) {
+    uint16_t bit = size >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      int16_t t = re[i];
+      re[i] = re[j];
+      re[j] = t;
+      t = im[i];
+      im[i] = im[j];
+      im[j] = t;
+    }
+  }
+  // Étages : un facteur de rotation lu en flash par groupe de papillons
+  for (uint16_t len = 2; len <= size; len <<= 1) {
+    uint16_t half = len >> 1;
+    uint32_t step = MAX_SIZE / len;
+    for (uint16_t j = 0; j < half; ++j) {
+      int32_t wr = cosQ15(j * step);
+      int32_t wi = -sinQ15(j * step);
+      for (uint16_t i = j; i < size; i += len) {
+        uint16_t k = i + half;
+        int32_t tr = (wr * re[k] - wi * im[k] + (1 << 14)) >> 15;
+        int32_t ti = (wr * im[k] + wi * re[k] + (1 << 14)) >> 15;
+        int32_t ur = re[i];
+        int32_t ui = im[i];
+        re[k] = static_cast<int16_t>((ur - tr) >> 1);
+        im[k] = static_cast<int16_t>((ui - ti) >> 1);
+        re[i] = static_cast<int16_t>((ur + tr) >> 1);
+        im[i] = static_cast<int16_t>((ui + ti) >> 1);
+      }
+    }
+  }
+}
+
+int16_t FixedFft::powerCentiDb(int32_t re, int32_t im) {
+  uint32_t p = static_cast<uint32_t>(re * re) + static_cast<uint32_t>(im * im);
+  if (p == 0) return FLOOR_CENTI_DB;
+  uint8_t msb = 31 - __builtin_clz(p);
+  // Mantisse en Q16, interpolée entre deux valeurs de la table
+  uint32_t frac = msb >= 16 ? (p >> (msb - 16)) & 0xFFFF : (p << (16 - msb)) & 0xFFFF;
+  uint32_t idx = frac >> 11;
+  uint32_t rem = frac & 0x7FF;
+  uint32_t lo = pgm_read_word(&kLog2[idx]);
+  uint32_t hi = pgm_read_word(&kLog2[idx + 1]);
+  uint32_t log2Q12 = (static_cast<uint32_t>(msb) << 12) + lo + (((hi - lo) * rem) >> 11);
+  // 10·log10(2) = 3,0103 dB par octave de puissance
+  return static_cast<int16_t>((log2Q12 * 30103u) / (4096u * 100u));
+}
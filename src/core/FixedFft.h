@@ -0,0 +1,60 @@
+/**
+ * @file FixedFft.h
+ * @brief FFT radix-2 en virgule fixe (Q15) pour l'analyse spectrale.
+ *
+ * L'ESP8266 n'a pas d'unité flottante : la transformée travaille sur
+ * des parties réelles et imaginaires int16 (Q15), avec des produits
+ * intermédiaires sur 32 bits.  Chaque étage divise le résultat par
+ * deux (arrondi), si bien qu'aucun papillon ne déborde et que la
+ * sortie vaut X[k] / N.
+ *
+ * Les facteurs de rotation sont lus dans un quart de sinusoïde de
+ * MAX_SIZE / 4 + 1 valeurs Q15 placé en PROGMEM (1 Ko de flash) ; les
+ * autres quadrants s'en déduisent par symétrie.  Les fenêtres (Hann,
+ * flat-top, Blackman-Harris à 4 termes) sont des sommes de cosinus
+ * calculées depuis la même table.  Les puissances sont converties en
+ * décibels par un logarithme entier (table de 33 valeurs, erreur
+ * inférieure à 0,01 dB).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class FixedFft {
+public:
+  static const uint16_t MIN_SIZE = 256;
+  static const uint16_t MAX_SIZE = 2048;
+  /** Niveau retourné pour une puissance nulle, en centièmes de dB. */
+  static const int16_t FLOOR_CENTI_DB = -20000;
+
+  enum Window : uint8_t { WINDOW_HANN, WINDOW_FLATTOP, WINDOW_BLACKMAN_HARRIS };
+
+  /** Décode "hann", "flattop" ou "blackman_harris" ; false si inconnu. */
+  static bool parseWindow(const String& name, Window& out);
+  static const char* windowName(Window w);
+  /** true pour une puissance de deux entre MIN_SIZE et MAX_SIZE. */
+  static bool validSize(uint32_t size);
+
+  /** sin(2π·m / MAX_SIZE) en Q15, m quelconque (modulo MAX_SIZE). */
+  static int16_t sinQ15(uint32_t m);
+  /** cos(2π·m / MAX_SIZE) en Q15. */
+  static int16_t cosQ15(uint32_t m) { return sinQ15(m + MAX_SIZE / 4); }
+  /**
+   * sin(2π·phase / 2^32) en Q15, interpolé linéairement entre deux
+   * valeurs de la table (erreur inférieure à un demi-LSB), pour un
+   * accumulateur de phase 32 bits.
+   */
+  static int16_t sinPhase(uint32_t phase);
+  static int16_t cosPhase(uint32_t phase) { return sinPhase(phase + 0x40000000UL); }
+
+  /** Coefficient Q15 de la fenêtre au point n d'une transformée de `size` points. */
+  static int16_t window(Window w, uint16_t n, uint16_t size);
+  /** Gain cohérent Q15 de la fenêtre (sa moyenne). */
+  static int16_t coherentGain(Window w);
+
+  /** Transformée directe en place de `size` points ; sortie divisée par `size`. */
+  static void transform(int16_t* re, int16_t* im, uint16_t size);
+  /** 10·log10(re² + im²) en centièmes de dB. */
+  static int16_t powerCentiDb(int32_t re, int32_t im);
+};
@@ -0,0 +1,159 @@
+/**
+ * @file HarmonicAnalyzer.cpp
+ * @brief Fin de bloc : puissances, suivi de la fondamentale et publication.
+ */
+
+#include "HarmonicAnalyzer.h"
+
+#include <math.h>
+
+void HarmonicAnalyzer::configure(uint8_t harmonics, uint8_t cycles) {
+  if (harmonics > MAX_HARMONICS) harmonics = MAX_HARMONICS;
+  _bins.assign(harmonics, Bin{0, 0});
+  _cycles = cycles ? cycles : 1;
+  reset();
+}
+
+void HarmonicAnalyzer::reset() {
+  // Premier bloc : composante continue inconnue, aucun passage compté
+  _dc = 0;
+  _hyst = INT32_MAX;
+  _phase = 0;
+  _tracked = false;
+  _result = Result();
+  startBlock(0.0f);
+}
+
+void HarmonicAnalyzer::startBlock(float frequency) {
+  _n = 0;
+  _sum = 0;
+  _sumSq = 0;
+  _min = INT32_MAX;
+  _max = INT32_MIN;
+  _weights = 0;
+  _c = 0;
+  _s = 0;
+  _cc = 0;
+  _ss = 0;
+  _cs = 0;
+  _xc = 0;
+  _xs = 0;
+  _crossings = 0;
+  _armed = false;
+  for (Bin& bin : _bins) bin = Bin{0, 0};
+  _window = 0;
+  uint32_t cycles = _cycles;
+  if (frequency > 0.0f && frequency < 0.5f) {
+    // Nombre entier de périodes, dans [MIN_BLOCK, MAX_BLOCK]
+    if (cycles > MAX_BLOCK * frequency) cycles = static_cast<uint32_t>(MAX_BLOCK * frequency);
+    if (cycles > 0 && cycles < MIN_BLOCK * frequency) cycles = static_cast<uint32_t>(ceilf(MIN_BLOCK * frequency));
+  } else {
+    cycles = 0;
+  }
+  if (cycles == 0) {
+    _frequency = 0.0f;
+    _inc = 0;
+    _tracked = false;
+    _length = UNLOCKED_BLOCK;
+    _windowInc = 0;
+    return;
+  }
+  _frequency = frequency;
+  _inc = static_cast<uint32_t>(frequency * 4294967296.0f);
+  _length = static_cast<uint32_t>(lroundf(cycles / frequency));
+  _windowInc = static_cast<uint32_t>((1ULL << 32) / _length);
+}
+
+void HarmonicAnalyzer::publish() {
+  uint32_t n = _n;
+  double mean = static_cast<double>(_sum) / n;
+  double energy = static_cast<double>(_sumSq);
+  double total = energy / n - mean * mean;
+  double next = 0.0;
+  Result r;
+  if (_inc && _weights > 0) {
+    // Moindres carrés x ≈ m + a·c + b·s : équations normales 3×3
+    double m00 = n, m01 = _c, m02 = _s, m11 = _cc, m12 = _cs, m22 = _ss;
+    double r0 = _sum, r1 = _xc, r2 = _xs;
+    double c00 = m11 * m22 - m12 * m12;
+    double c01 = m02 * m12 - m01 * m22;
+    double c02 = m01 * m12 - m02 * m11;
+    double det = m00 * c00 + m01 * c01 + m02 * c02;
+    double a = 0.0;
+    double b = 0.0;
+    double residual = 0.0;
+    if (det != 0.0) {
+      double c11 = m00 * m22 - m02 * m02;
+      double c12 = m01 * m02 - m00 * m12;
+      double c22 = m00 * m11 - m01 * m01;
+      double dc = (c00 * r0 + c01 * r1 + c02 * r2) / det;
+      a = (c01 * r0 + c11 * r1 + c12 * r2) / det;
+      b = (c02 * r0 + c12 * r1 + c22 * r2) / det;
+      residual = (energy - (dc * r0 + a * r1 + b * r2)) / n;
+      if (residual < 0.0) residual = 0.0;
+    }
+    // Table Q15 : amplitude 32767
+    double a1 = 32767.0 * sqrt(a * a + b * b);
+    double p1 = a1 * a1 / 2.0;
+    next = _frequency;
+    // Fondamentale dominante : suivi fin par la dérive de phase
+    if (p1 > 0.0 && p1 >= 0.5 * total) {
+      double phase = atan2(-b, a);
+      if (_tracked) {
+        double drift = phase - _lastPhase;
+        if (drift > M_PI) drift -= 2.0 * M_PI;
+        if (drift < -M_PI) drift += 2.0 * M_PI;
+        // Déphasage accumulé entre les centres des deux blocs
+        double span = (_lastLength + n) / 2.0;
+        next = (drift / (2.0 * M_PI) + _lastFrequency * _lastLength / 2.0 + _frequency * n / 2.0) / span;
+      }
+      _lastPhase = phase;
+      _lastFrequency = _frequency;
+      _lastLength = n;
+      _tracked = fabs(next - _frequency) <= 1.0 / n;
+      r.valid = _tracked;
+    } else {
+      _tracked = false;
+    }
+    if (r.valid) {
+      // Amplitude crête d'une harmonique : 2·|corrélation| / somme des poids
+      double harmonics = 0.0;
+      for (size_t h = 0; h < _bins.size() && (h + 2) * _frequency < 0.5f; ++h) {
+        double hr = static_cast<double>(_bins[h].re);
+        double hi = static_cast<double>(_bins[h].im);
+        double ah = 2.0 * sqrt(hr * hr + hi * hi) / _weights;
+        double ph = ah * ah / 2.0;
+        harmonics += ph;
+        r.levels.push_back(static_cast<float>(10.0 * log10(ph / p1 + 1e-20)));
+      }
+      r.frequency = static_cast<float>(next);
+      r.amplitude = static_cast<float>(a1);
+      r.thd = static_cast<float>(sqrt(harmonics / p1));
+      r.thdn = static_cast<float>(sqrt(residual / p1));
+      r.sinad = static_cast<float>(10.0 * log10(total / (residual + 1e-12 * total)));
+    }
+  }
+  if (!r.valid && _crossings >= 2 && _lastCrossing > _firstCrossing) {
+    // Accrochage (ou réaccrochage) sur les passages montants
+    next = (_crossings - 1) / (_lastCrossing - _firstCrossing);
+    _tracked = false;
+  }
+  _result = r;
+  _dc += static_cast<int32_t>(lround(mean));
+  _hyst = (_max - _min) / 20;
+  if (_hyst < 1) _hyst = 1;
+  startBlock(static_cast<float>(next));
+}
+
+void HarmonicAnalyzer::toJson(JsonObject& out, float sampleHz, float voltsPerCode) const {
+  const Result& r = _result;
+  out["valid"] = r.valid;
+  if (!r.valid) return;
+  out["fundamental_hz"] = r.frequency * sampleHz;
+  out["fundamental_vrms"] = r.amplitude * fabsf(voltsPerCode) * static_cast<float>(M_SQRT1_2);
+  out["thd_percent"] = r.thd * 100.0f;
+  out["thdn_percent"] = r.thdn * 100.0f;
+  out["sinad_db"] = r.sinad;
+  JsonArray levels = out["harmonics_dbc"].to<JsonArray>();
+  for (float level : r.levels) levels.add(level);
+}
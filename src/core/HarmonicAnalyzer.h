@@ -0,0 +1,176 @@
+/**
+ * @file HarmonicAnalyzer.h
+ * @brief Analyse harmonique continue d'un flux d'échantillons (THD, THD+N, SINAD).
+ *
+ * Chaque échantillon, corrigé de la composante continue, est corrélé
+ * avec la fondamentale et ses harmoniques : une raie de DFT par
+ * fréquence, à la manière d'un filtre de Goertzel, mais évaluée par
+ * deux produits entiers (sinus et cosinus lus dans la table de FixedFft
+ * au moyen d'un accumulateur de phase 32 bits).  La récurrence de
+ * Goertzel, dont l'état croît comme N / sin(ω), déborderait 32 bits dès
+ * que la fondamentale est très suréchantillonnée ; la corrélation
+ * directe reste bornée.  Mémoire constante : deux accumulateurs
+ * 64 bits par harmonique.
+ *
+ * Les harmoniques sont pondérées par une fenêtre de Hann, qui les
+ * protège des fuites de la fondamentale.  La fondamentale est ajustée
+ * au sens des moindres carrés (sinusoïde à trois paramètres : continu,
+ * cosinus, sinus) à partir de quelques sommes entières de plus ; le
+ * résidu de l'ajustement est exactement la puissance de tout ce qui
+ * n'est pas la fondamentale, sans l'erreur qu'apporterait la
+ * différence de deux grandes puissances estimées séparément.
+ *
+ * Les résultats sont publiés à la fin de chaque bloc d'un nombre
+ * entier de périodes ("cycles") de la fondamentale, sans attendre de
+ * capture.  La fondamentale est suivie d'un bloc à l'autre :
+ * - grossièrement, par les passages montants à la moyenne (avec
+ *   hystérésis) comptés pendant le bloc ;
+ * - finement, par la dérive de la phase de sa raie entre deux blocs
+ *   consécutifs, l'accumulateur de phase n'étant jamais remis à zéro.
+ * Tant qu'aucune fondamentale n'est connue, les blocs durent
+ * UNLOCKED_BLOCK échantillons ; deux blocs suffisent pour l'accrocher.
+ *
+ * - THD : √(ΣP_h) / √P_1 pour les harmoniques sous la fréquence de
+ *   Nyquist ;
+ * - THD+N : √P_résidu / √P_1 ;
+ * - SINAD : 10·log10(P_totale / P_résidu), P_totale étant la puissance
+ *   alternative du bloc (tout sauf la composante continue).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "FixedFft.h"
+
+class HarmonicAnalyzer {
+public:
+  static const uint8_t MAX_HARMONICS = 15;    ///< Harmoniques 2 à 16
+  static const uint16_t MIN_BLOCK = 32;
+  static const uint16_t MAX_BLOCK = 4096;
+  static const uint16_t UNLOCKED_BLOCK = 512;
+
+  struct Result {
+    bool valid = false;
+    float frequency = 0.0f;   ///< Fondamentale en cycles par échantillon
+    float amplitude = 0.0f;   ///< Amplitude crête de la fondamentale, en codes
+    float thd = 0.0f;         ///< Rapports d'amplitude, pas des pourcentages
+    float thdn = 0.0f;
+    float sinad = 0.0f;       ///< En dB
+    std::vector<float> levels;  ///< Harmoniques 2, 3, ... sous Nyquist, en dBc
+  };
+
+  /** Harmoniques analysées en plus de la fondamentale, périodes par bloc. */
+  void configure(uint8_t harmonics, uint8_t cycles);
+  /** Oublie la fondamentale et les résultats (changement de cadence). */
+  void reset();
+  uint8_t harmonics() const { return static_cast<uint8_t>(_bins.size()); }
+  const Result& result() const { return _result; }
+
+  /**
+   * Publie le dernier résultat : fréquence en Hz pour `sampleHz`
+   * échantillons par seconde, amplitude efficace pour `voltsPerCode`.
+   */
+  void toJson(JsonObject& out, float sampleHz, float voltsPerCode) const;
+
+  /** Ajoute un échantillon : quelques comparaisons et deux produits par harmonique. */
+  void push(int16_t code) {
+    int32_t x = static_cast<int32_t>(code) - _dc;
+    if (x > 32767) x = 32767;
+    if (x < -32768) x = -32768;
+    _sum += x;
+    // Produits en 64 bits : x * x déborde un int32 au-delà de ±46340
+    _sumSq += static_cast<uint64_t>(static_cast<int64_t>(x) * x);
+    if (x < _min) _min = x;
+    if (x > _max) _max = x;
+    if (x < -_hyst) {
+      _armed = true;
+    } else if (_armed && x >= 0) {
+      crossing(x);
+    }
+    _prev = x;
+    if (_inc) correlate(x);
+    if (++_n >= _length) publish();
+  }
+
+private:
+  struct Bin {
+    int64_t re;
+    int64_t im;
+  };
+  std::vector<Bin> _bins;     ///< Harmoniques 2, 3, ...
+  uint8_t _cycles = 10;
+
+  // Bloc en cours
+  uint32_t _n = 0;
+  uint32_t _length = UNLOCKED_BLOCK;
+  int32_t _dc = 0;            ///< Moyenne du bloc précédent, en codes
+  int64_t _sum = 0;
+  uint64_t _sumSq = 0;
+  int32_t _min = 0;
+  int32_t _max = 0;
+  int32_t _prev = 0;
+  uint32_t _weights = 0;      ///< Somme des coefficients de la fenêtre (Q15)
+  // Sommes de l'ajustement de la fondamentale (c = cos, s = sin, Q15)
+  int64_t _c = 0;
+  int64_t _s = 0;
+  int64_t _cc = 0;
+  int64_t _ss = 0;
+  int64_t _cs = 0;
+  int64_t _xc = 0;
+  int64_t _xs = 0;
+
+  // Passages montants (estimation grossière)
+  int32_t _hyst = 0;
+  bool _armed = false;
+  uint16_t _crossings = 0;
+  float _firstCrossing = 0.0f;
+  float _lastCrossing = 0.0f;
+
+  // Fondamentale suivie
+  uint32_t _phase = 0;        ///< Phase de la fondamentale (un tour = 2^32)
+  uint32_t _inc = 0;          ///< Incrément par échantillon, 0 : non accrochée
+  uint32_t _window = 0;       ///< Phase de la fenêtre de Hann
+  uint32_t _windowInc = 0;
+  float _frequency = 0.0f;    ///< Fréquence de _inc, en cycles par échantillon
+  bool _tracked = false;      ///< Phase du bloc précédent disponible
+  float _lastPhase = 0.0f;
+  float _lastFrequency = 0.0f;
+  uint32_t _lastLength = 0;
+
+  Result _result;
+
+  void correlate(int32_t x) {
+    int32_t c = FixedFft::cosPhase(_phase);
+    int32_t s = FixedFft::sinPhase(_phase);
+    _c += c;
+    _s += s;
+    _cc += c * c;
+    _ss += s * s;
+    _cs += c * s;
+    _xc += static_cast<int64_t>(x) * c;
+    _xs += static_cast<int64_t>(x) * s;
+    int32_t w = (32767 - FixedFft::cosPhase(_window)) >> 1;
+    _window += _windowInc;
+    _weights += w;
+    int32_t xw = static_cast<int32_t>((static_cast<int64_t>(x) * w + (1 << 14)) >> 15);
+    uint32_t phase = _phase;
+    for (Bin& bin : _bins) {
+      phase += _phase;
+      bin.re += xw * FixedFft::cosPhase(phase);
+      bin.im += xw * FixedFft::sinPhase(phase);
+    }
+    _phase += _inc;
+  }
+  void crossing(int32_t x) {
+    float t = static_cast<float>(_n) - 1.0f + static_cast<float>(-_prev) / (x - _prev);
+    if (_crossings == 0) _firstCrossing = t;
+    _lastCrossing = t;
+    _crossings++;
+    _armed = false;
+  }
+  void publish();
+  void startBlock(float frequency);
+};
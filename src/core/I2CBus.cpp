@@ -0,0 +1,105 @@
+/**
+ * @file I2CBus.cpp
+ * @brief Implémentation de l'abstraction du bus I2C.
+ */
+
+#include "I2CBus.h"
+
+#ifdef ARDUINO_ARCH_ESP8266
+#include <Wire.h>
+
+static WireBus _wireBus;
+I2CBus* I2CBus::_active = &_wireBus;
+
+// Demi-période des impulsions de déblocage (environ 100 kHz)
+static const uint32_t RECOVER_HALF_PERIOD_US = 5;
+
+void WireBus::begin(uint8_t sda, uint8_t scl) {
+  _sda = sda;
+  _scl = scl;
+  Wire.begin(_sda, _scl);
+  Wire.setClock(_clockHz);
+}
+
+bool WireBus::write(uint8_t addr, const uint8_t* data, size_t len) {
+  Wire.beginTransmission(addr);
+  Wire.write(data, len);
+  return Wire.endTransmission() == 0;
+}
+
+bool WireBus::read(uint8_t addr, uint8_t* data, size_t len) {
+  size_t got = Wire.requestFrom(addr, static_cast<uint8_t>(len));
+  if (got != len) {
+    while (Wire.available()) Wire.read();
+    return false;
+  }
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = static_cast<uint8_t>(Wire.read());
+  }
+  return true;
+}
+
+void WireBus::setClock(uint32_t hz) {
+  _clockHz = hz;
+  Wire.setClock(hz);
+}
+
+bool WireBus::recover() {
+  // Un esclave interrompu au milieu d'un octet maintient SDA basse en
+  // attendant ses impulsions d'horloge : on en génère jusqu'à neuf en
+  // drain ouvert, puis une condition STOP (SDA monte, SCL haute).
+  pinMode(_sda, INPUT_PULLUP);
+  pinMode(_scl, INPUT_PULLUP);
+  delayMicroseconds(RECOVER_HALF_PERIOD_US);
+  for (int i = 0; i < 9 && digitalRead(_sda) == LOW; ++i) {
+    pinMode(_scl, OUTPUT);
+    digitalWrite(_scl, LOW);
+    delayMicroseconds(RECOVER_HALF_PERIOD_US);
+    pinMode(_scl, INPUT_PULLUP);
+    delayMicroseconds(RECOVER_HALF_PERIOD_US);
+  }
+  pinMode(_sda, OUTPUT);
+  digitalWrite(_sda, LOW);
+  delayMicroseconds(RECOVER_HALF_PERIOD_US);
+  pinMode(_sda, INPUT_PULLUP);
+  delayMicroseconds(RECOVER_HALF_PERIOD_US);
+  bool free = digitalRead(_sda) == HIGH && digitalRead(_scl) == HIGH;
+  begin(_sda, _scl);
+  return free;
+}
+
+bool WireBus::sdaHeld() {
+  return digitalRead(_sda) == LOW;
+}
+#else
+I2CBus* I2CBus::_active = nullptr;
+#endif
+
+bool I2CBus::writeReg16(uint8_t addr, uint8_t reg, uint16_t value) {
+  uint8_t buf[3] = {reg, static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value & 0xFF)};
+  return write(addr, buf, sizeof(buf));
+}
+
+bool I2CBus::readReg16(uint8_t addr, uint8_t reg, uint16_t& value) {
+  if (!write(addr, &reg, 1)) return false;
+  uint8_t buf[2];
+  if (!read(addr, buf, sizeof(buf))) return false;
+  value = (static_cast<uint16_t>(buf[0]) << 8) | buf[1];
+  return true;
+}
+
+I2CBus& I2CBus::active() {
+  return *_active;
+}
+
+void I2CBus::setActive(I2CBus* bus) {
+  _active = bus ? bus : hardware();
+}
+
+I2CBus* I2CBus::hardware() {
+#ifdef ARDUINO_ARCH_ESP8266
+  return &_wireBus;
+#else
+  return nullptr;
+#endif
+}
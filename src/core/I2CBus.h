@@ -0,0 +1,70 @@
+/**
+ * @file I2CBus.h
+ * @brief Abstraction minimale du bus I2C utilisé par les pilotes MiniLabo.
+ *
+ * Les pilotes des convertisseurs (ADS1115, MCP4725) n'accèdent pas
+ * directement à Wire mais à une instance de I2CBus.  Sur la carte, le
+ * bus actif est WireBus ; sur PC, un SimI2CBus (voir SimI2C.h) simule
+ * les registres des composants pour vérifier les pilotes sans
+ * matériel.  En fonctionnement, le bus actif est celui de
+ * l'I2CManager, qui comptabilise les transactions et les relaie au
+ * bus physique.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class I2CBus {
+public:
+  virtual ~I2CBus() {}
+  /** Écrit `len` octets vers l'esclave ; false si NACK ou erreur. */
+  virtual bool write(uint8_t addr, const uint8_t* data, size_t len) = 0;
+  /** Lit `len` octets depuis l'esclave ; false si NACK ou lecture courte. */
+  virtual bool read(uint8_t addr, uint8_t* data, size_t len) = 0;
+  /** Fixe la fréquence d'horloge SCL en Hz. */
+  virtual void setClock(uint32_t hz) { (void)hz; }
+  /**
+   * Tente de débloquer un bus dont un esclave maintient SDA basse
+   * (impulsions SCL puis STOP).  Retourne true si le bus est libre.
+   */
+  virtual bool recover() { return true; }
+  /**
+   * true si SDA est basse bus au repos : un esclave bloque le bus.
+   * Après un simple NACK (composant absent ou occupé), SDA est libre.
+   */
+  virtual bool sdaHeld() { return false; }
+
+  /** Écrit un registre 16 bits (pointeur puis MSB, LSB). */
+  bool writeReg16(uint8_t addr, uint8_t reg, uint16_t value);
+  /** Lit un registre 16 bits (écriture du pointeur puis lecture MSB, LSB). */
+  bool readReg16(uint8_t addr, uint8_t reg, uint16_t& value);
+
+  /** Retourne le bus utilisé par les pilotes. */
+  static I2CBus& active();
+  /** Remplace le bus utilisé par les pilotes (nullptr pour revenir à Wire). */
+  static void setActive(I2CBus* bus);
+  /** Bus matériel de la carte (nullptr hors ESP8266). */
+  static I2CBus* hardware();
+
+private:
+  static I2CBus* _active;
+};
+
+#ifdef ARDUINO_ARCH_ESP8266
+/** Bus matériel basé sur l'objet Wire du core ESP8266. */
+class WireBus : public I2CBus {
+public:
+  /** Démarre Wire sur les broches données. */
+  void begin(uint8_t sda, uint8_t scl);
+  bool write(uint8_t addr, const uint8_t* data, size_t len) override;
+  bool read(uint8_t addr, uint8_t* data, size_t len) override;
+  void setClock(uint32_t hz) override;
+  bool recover() override;
+  bool sdaHeld() override;
+private:
+  uint8_t _sda = SDA;
+  uint8_t _scl = SCL;
+  uint32_t _clockHz = 100000;
+};
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file I2CManager.cpp
+ * @brief Implémentation du gestionnaire du bus I2C partagé.
+ */
+
+#include "I2CManager.h"
+#include "ConfigStore.h"
+#include "Logger.h"
+
+// En-tête d'une écriture en file : adresse, longueur, instant de dépôt
+static const size_t FRAME_HEADER = 6;
+
+// Une image complète de l'écran (1 Ko découpé en blocs de 24 octets
+// par U8g2) et ses commandes de page tiennent dans cette file.
+static uint8_t _displayBuf[2048];
+
+I2CManager::ManagedBus I2CManager::_managed;
+I2CBus* I2CManager::_phys = nullptr;
+uint32_t I2CManager::_clockHz = 400000;
+uint32_t I2CManager::_budgetUs = 1000;
+I2CManager::Queue I2CManager::_queue = {_displayBuf, sizeof(_displayBuf), 0, 0, 0, 0};
+std::map<uint8_t, I2CManager::DeviceStats> I2CManager::_devices;
+uint8_t I2CManager::_consecutiveErrors = 0;
+uint32_t I2CManager::_recoveries = 0;
+
+void I2CManager::begin() {
+  auto& doc = ConfigStore::doc("io");
+  JsonVariant cfg = doc["i2c"];
+  uint8_t sda = cfg["sda"] | 12;
+  uint8_t scl = cfg["scl"] | 14;
+  uint32_t clock = cfg["clock_hz"] | 400000;
+  _budgetUs = cfg["budget_us"] | 1000;
+#ifdef ARDUINO_ARCH_ESP8266
+  static_cast<WireBus*>(I2CBus::hardware())->begin(sda, scl);
+#else
+  (void)sda;
+  (void)scl;
+#endif
+  setBus(nullptr);
+  setClock(clock);
+  Logger::info("I2C", "begin", String("Bus @ ") + _clockHz + " Hz");
+}
+
+void I2CManager::setBus(I2CBus* bus) {
+  _phys = bus ? bus : I2CBus::hardware();
+  _queue.head = 0;
+  _queue.used = 0;
+  _queue.frames = 0;
+  _consecutiveErrors = 0;
+  I2CBus::setActive(&_managed);
+}
+
+void I2CManager::setClock(uint32_t hz) {
+  if (hz < 100000) hz = 100000;
+  if (hz > 1000000) hz = 1000000;
+  _clockHz = hz;
+  if (_phys) _phys->setClock(hz);
+}
+
+uint32_t I2CManager::costUs(size_t len) {
+  // 9 bits par octet, octet d'adresse compris, plus START/STOP
+  return static_cast<uint32_t>((len + 1) * 9ULL * 1000000ULL / _clockHz) + 10;
+}
+
+void I2CManager::account(uint8_t addr, size_t len, bool ok, uint32_t latencyUs) {
+  DeviceStats &d = _devices[addr];
+  d.transactions++;
+  d.latencySumUs += latencyUs;
+  if (latencyUs > d.latencyMaxUs) d.latencyMaxUs = latencyUs;
+  if (ok) {
+    d.bytes += len;
+    _consecutiveErrors = 0;
+    return;
+  }
+  d.errors++;
+  if (!_phys || !_phys->sdaHeld()) {
+    // NACK sur un bus libre : rien à débloquer
+    _consecutiveErrors = 0;
+    return;
+  }
+  if (++_consecutiveErrors >= RECOVER_AFTER_ERRORS) {
+    _consecutiveErrors = 0;
+    recover();
+  }
+}
+
+bool I2CManager::recover() {
+  if (!_phys) return false;
+  _recoveries++;
+  bool ok = _phys->recover();
+  _phys->setClock(_clockHz);
+  Logger::warn("I2C", "recover", ok ? "Bus released" : "Bus still held low");
+  return ok;
+}
+
+bool I2CManager::ManagedBus::write(uint8_t addr, const uint8_t* data, size_t len) {
+  if (!_phys) return false;
+  uint32_t t0 = micros();
+  bool ok = _phys->write(addr, data, len);
+  account(addr, len, ok, micros() - t0);
+  return ok;
+}
+
+bool I2CManager::ManagedBus::read(uint8_t addr, uint8_t* data, size_t len) {
+  if (!_phys) return false;
+  uint32_t t0 = micros();
+  bool ok = _phys->read(addr, data, len);
+  account(addr, len, ok, micros() - t0);
+  return ok;
+}
+
+void I2CManager::pushBytes(Queue& q, const uint8_t* data, size_t len) {
+  size_t tail = (q.head + q.used) % q.capacity;
+  for (size_t i = 0; i < len; ++i) {
+    q.buf[tail] = data[i];
+    if (++tail == q.capacity) tail = 0;
+  }
+  q.used += len;
+}
+
+void I2CManager::popBytes(Queue& q, uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = q.buf[q.head];
+    if (++q.head == q.capacity) q.head = 0;
+  }
+  q.used -= len;
+}
+
+bool I2CManager::submit(uint8_t addr, const uint8_t* data, size_t len) {
+  if (len == 0 || len > MAX_CHUNK) return false;
+  Queue &q = _queue;
+  if (q.capacity - q.used < FRAME_HEADER + len) {
+    q.dropped++;
+    return false;
+  }
+  uint32_t now = micros();
+  uint8_t header[FRAME_HEADER] = {
+    addr, static_cast<uint8_t>(len),
+    static_cast<uint8_t>(now), static_cast<uint8_t>(now >> 8),
+    static_cast<uint8_t>(now >> 16), static_cast<uint8_t>(now >> 24)
+  };
+  pushBytes(q, header, FRAME_HEADER);
+  pushBytes(q, data, len);
+  q.frames++;
+  return true;
+}
+
+bool I2CManager::runFront(Queue& q) {
+  uint8_t header[FRAME_HEADER];
+  uint8_t data[MAX_CHUNK];
+  popBytes(q, header, FRAME_HEADER);
+  size_t len = header[1];
+  popBytes(q, data, len);
+  q.frames--;
+  uint32_t queued = static_cast<uint32_t>(header[2]) |
+                    (static_cast<uint32_t>(header[3]) << 8) |
+                    (static_cast<uint32_t>(header[4]) << 16) |
+                    (static_cast<uint32_t>(header[5]) << 24);
+  bool ok = _phys && _phys->write(header[0], data, len);
+  // La latence d'une écriture en file inclut son attente
+  account(header[0], len, ok, micros() - queued);
+  return ok;
+}
+
+void I2CManager::loop() {
+  service(_budgetUs);
+}
+
+void I2CManager::service(uint32_t budgetUs) {
+  uint32_t spent = 0;
+  bool any = false;
+  while (_queue.frames > 0) {
+    size_t len = _queue.buf[(_queue.head + 1) % _queue.capacity];
+    uint32_t cost = costUs(len);
+    if (any && spent + cost > budgetUs) return;
+    runFront(_queue);
+    spent += cost;
+    any = true;
+  }
+}
+
+void I2CManager::flush() {
+  while (_queue.frames > 0) runFront(_queue);
+}
+
+bool I2CManager::idle() {
+  return _queue.frames == 0;
+}
+
+size_t I2CManager::space() {
+  const Queue &q = _queue;
+  size_t free = q.capacity - q.used;
+  return free > FRAME_HEADER ? free - FRAME_HEADER : 0;
+}
+
+void I2CManager::stats(JsonObject& out) {
+  out["clock_hz"] = _clockHz;
+  out["budget_us"] = _budgetUs;
+  out["recoveries"] = _recoveries;
+  JsonObject q = out["queues"]["display"].to<JsonObject>();
+  q["pending"] = _queue.frames;
+  q["bytes"] = _queue.used;
+  q["dropped"] = _queue.dropped;
+  JsonArray arr = out["devices"].to<JsonArray>();
+  for (const auto &kv : _devices) {
+    JsonObject d = arr.add<JsonObject>();
+    d["address"] = kv.first;
+    d["transactions"] = kv.second.transactions;
+    d["errors"] = kv.second.errors;
+    d["bytes"] = kv.second.bytes;
+    d["latency_avg_us"] = kv.second.transactions ?
+        kv.second.latencySumUs / kv.second.transactions : 0;
+    d["latency_max_us"] = kv.second.latencyMaxUs;
+  }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file I2CManager.h
+ * @brief Gestionnaire du bus I2C partagé (ADS1115, MCP4725, OLED).
+ *
+ * Tous les composants I2C de la carte partagent un seul bus.  Sans
+ * coordination, un sendBuffer() complet de l'écran (1 Ko, plusieurs
+ * dizaines de ms) retarde d'autant les lectures d'acquisition.  Le
+ * gestionnaire :
+ * - relaie les transactions synchrones des pilotes (I2CBus::active())
+ *   et en mesure la durée ;
+ * - met en file les écritures de l'écran et les exécute dans loop()
+ *   dans la limite d'un budget de temps de bus par appel.  Les
+ *   transferts sont découpés en blocs de MAX_CHUNK octets au plus :
+ *   les transactions synchrones de l'ADS1115 et du MCP4725, qui
+ *   attendent leur résultat, passent entre deux blocs ;
+ * - applique la fréquence d'horloge configurée et débloque le bus
+ *   après plusieurs erreurs consécutives avec SDA maintenue basse (un
+ *   NACK d'un composant absent, que IORegistry sonde périodiquement,
+ *   ne bloque pas le bus) ;
+ * - tient des compteurs de latence et d'erreurs par adresse.
+ *
+ * Configuration (section "i2c" de io.json) :
+ * - sda, scl : broches du bus (par défaut 12 et 14) ;
+ * - clock_hz : fréquence SCL (100000 à 1000000, par défaut 400000) ;
+ * - budget_us : temps de bus estimé alloué aux files par appel de
+ *   loop() (par défaut 1000).
+ *
+ * Sur PC, setBus() remplace le bus physique par un SimI2CBus.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <map>
+
+#include "I2CBus.h"
+
+class I2CManager {
+public:
+  /** Taille maximale d'une écriture mise en file. */
+  static const size_t MAX_CHUNK = 32;
+
+  /** Démarre le bus matériel selon io.json et installe le gestionnaire. */
+  static void begin();
+  /** Remplace le bus physique (nullptr pour le bus matériel) et installe le gestionnaire. */
+  static void setBus(I2CBus* bus);
+  /** Change la fréquence SCL du bus. */
+  static void setClock(uint32_t hz);
+  static uint32_t clockHz() { return _clockHz; }
+  /** Fixe le budget de temps de bus par appel de loop(). */
+  static void setBudgetUs(uint32_t us) { _budgetUs = us; }
+
+  /**
+   * Met en file une écriture de `len` octets (au plus MAX_CHUNK).
+   * Retourne false si la file est pleine.
+   */
+  static bool submit(uint8_t addr, const uint8_t* data, size_t len);
+  /** Exécute les écritures en file dans le budget configuré. */
+  static void loop();
+  /**
+   * Exécute les écritures en file, dans l'ordre, jusqu'à épuisement de
+   * `budgetUs` de temps de bus estimé.  Au moins une transaction est
+   * exécutée si la file n'est pas vide.
+   */
+  static void service(uint32_t budgetUs);
+  /** Exécute toutes les écritures en file. */
+  static void flush();
+  /** true si aucune écriture n'est en attente. */
+  static bool idle();
+  /** Octets libres dans la file. */
+  static size_t space();
+  /** Compteurs du bus et de chaque adresse pour l'API REST. */
+  static void stats(JsonObject& out);
+
+private:
+  /** Bus installé comme I2CBus::active() : relaie et mesure. */
+  class ManagedBus : public I2CBus {
+  public:
+    bool write(uint8_t addr, const uint8_t* data, size_t len) override;
+    bool read(uint8_t addr, uint8_t* data, size_t len) override;
+    void setClock(uint32_t hz) override { I2CManager::setClock(hz); }
+    bool recover() override { return I2CManager::recover(); }
+    bool sdaHeld() override { return _phys && _phys->sdaHeld(); }
+  };
+
+  /** File d'octets circulaire : [addr][len][t0 ×4][données]. */
+  struct Queue {
+    uint8_t* buf;
+    size_t capacity;
+    size_t head;      ///< Prochain octet lu
+    size_t used;
+    uint32_t frames;
+    uint32_t dropped; ///< Écritures refusées (file pleine)
+  };
+
+  struct DeviceStats {
+    uint32_t transactions = 0;
+    uint32_t errors = 0;
+    uint32_t bytes = 0;
+    uint32_t latencySumUs = 0;
+    uint32_t latencyMaxUs = 0;
+  };
+
+  static const uint8_t RECOVER_AFTER_ERRORS = 3;
+  static ManagedBus _managed;
+  static I2CBus* _phys;
+  static uint32_t _clockHz;
+  static uint32_t _budgetUs;
+  static Queue _queue;
+  static std::map<uint8_t, DeviceStats> _devices;
+  static uint8_t _consecutiveErrors;
+  static uint32_t _recoveries;
+
+  static bool recover();
+  static void account(uint8_t addr, size_t len, bool ok, uint32_t latencyUs);
+  static uint32_t costUs(size_t len);
+  static void pushBytes(Queue& q, const uint8_t* data, size_t len);
+  static void popBytes(Queue& q, uint8_t* data, size_t len);
+  static bool runFront(Queue& q);
+};
@@ -6,14 +6,11 @@
 #include "IORegistry.h"
 #include "ConfigStore.h"
 #include "Logger.h"
+#include "SelfCal.h"
+#include "Trace.h"
 
 #include <ArduinoJson.h>
 
-// Ajout des pilotes externes pour les ADC et DAC I2C
-#include <Wire.h>
-#include <Adafruit_ADS1X15.h>
-#include <Adafruit_MCP4725.h>
-
 // Carte NodeMCU ESP8266: broche PWM utilisée pour le module 0–10 V
 // Le choix de la broche dépend du matériel; D1 (GPIO5) est un exemple.
 // Broche PWM pour la sortie 0–10 V.  Choisissez une broche libre qui
@@ -21,48 +18,121 @@
 // être ajusté selon votre schéma matériel.
 static constexpr uint8_t PIN_0_10V_OUT = D3;
 
-// Cartes partagées pour gérer plusieurs périphériques sur le même bus
-static std::map<uint8_t, Adafruit_ADS1115*> _adsDevices;
-static std::map<uint8_t, Adafruit_MCP4725*> _dacDevices;
+// Composants I2C partagés par les IO : un pilote et un état de santé
+// par adresse.
+namespace {
+  struct I2CDevice {
+    const char* driver;
+    uint8_t address;
+    AdsScheduler* ads = nullptr;
+    Mcp4725* dac = nullptr;
+    DeviceHealth health;
+  };
+  std::vector<I2CDevice*> _i2cDevices;
 
-/**
- * Convertit une tension plein‑échelle (pga en volts) en constante
- * adsGain_t pour la bibliothèque Adafruit ADS1X15.  La carte ADS1115
- * propose plusieurs gains correspondants aux valeurs ±6.144 V,
- * ±4.096 V, ±2.048 V, ±1.024 V, ±0.512 V et ±0.256 V.  On choisit
- * le gain le plus élevé inférieur ou égal à la valeur passée.
- */
-static adsGain_t pgaToGain(float pga) {
-  if (pga >= 6.144f) return GAIN_TWOTHIRDS; // ±6.144 V
-  if (pga >= 4.096f) return GAIN_ONE;       // ±4.096 V
-  if (pga >= 2.048f) return GAIN_TWO;       // ±2.048 V
-  if (pga >= 1.024f) return GAIN_FOUR;      // ±1.024 V
-  if (pga >= 0.512f) return GAIN_EIGHT;     // ±0.512 V
-  return GAIN_SIXTEEN;                      // ±0.256 V
+  I2CDevice* findDevice(const char* driver, uint8_t address) {
+    for (auto d : _i2cDevices) {
+      if (d->address == address && strcmp(d->driver, driver) == 0) return d;
+    }
+    return nullptr;
+  }
+
+  bool probeDevice(I2CDevice* d) {
+    if (d->ads) {
+      if (!d->ads->device()->begin()) return false;
+      d->ads->reset();
+      return true;
+    }
+    return d->dac && d->dac->begin();
+  }
+
+  String hexAddress(uint8_t address) {
+    return String("0x") + String(address, HEX);
+  }
+
+  // Amplitude et décalage en volts, convertis en codes de pleine échelle
+  IO_Sim* createSim(const String& id, JsonObject dev) {
+    float range = dev["range"] | 4.096f;
+    if (range <= 0.0f) range = 4.096f;
+    IO_Sim* io = new IO_Sim(id, range);
+    SimSignal::Waveform wave;
+    String name = dev["waveform"] | "sine";
+    if (!SimSignal::parseWaveform(name, wave)) {
+      Logger::warn("IO", "sim", String("Unknown waveform ") + name + " for " + id);
+      wave = SimSignal::SINE;
+    }
+    float volts = io->scale();
+    io->signal().configure(wave, dev["freq_hz"] | 50.0f, dev["sample_rate_hz"] | 1000,
+                           static_cast<int32_t>((dev["amplitude"] | 1.0f) / volts),
+                           static_cast<int32_t>((dev["offset"] | 0.0f) / volts),
+                           dev["seed"] | 1);
+    if (wave == SimSignal::FILE_DATA) {
+      String path = dev["file"] | "";
+      if (!io->signal().loadFile(path, volts)) {
+        Logger::error("IO", "sim", String("Cannot load ") + path + " for " + id);
+      }
+    }
+    return io;
+  }
+
+  // Sorties simulées de ce begin(), sources des bouclages "sim_loopback"
+  std::vector<IO_SimOut*> _simOutputs;
+
+  IO_SimLoopback* createLoopback(const String& id, JsonObject dev) {
+    String sourceId = dev["source"] | "";
+    IO_SimOut* source = nullptr;
+    for (auto out : _simOutputs) {
+      if (out->id() == sourceId) source = out;
+    }
+    if (!source) {
+      Logger::error("IO", "sim_loopback", String("Unknown sim_out source ") + sourceId +
+                    " for " + id);
+      return nullptr;
+    }
+    float range = dev["range"] | 4.096f;
+    if (range <= 0.0f) range = 4.096f;
+    IO_SimLoopback* io = new IO_SimLoopback(id, range, source);
+    io->setResponse(dev["gain"] | 1.0f, dev["offset"] | 0.0f, dev["noise"] | 0.0f,
+                    dev["seed"] | 1);
+    return io;
+  }
 }
 
 std::vector<IOBase*> IORegistry::_list;
-std::map<String, IOBase*> IORegistry::_map;
+std::map<String, IOHandle> IORegistry::_map;
+IOSnapshot IORegistry::_snapshot;
 
 void IORegistry::registerIO(IOBase* io) {
+  _map[io->id()] = static_cast<IOHandle>(_list.size());
   _list.push_back(io);
-  _map[io->id()] = io;
   Logger::info("IO", "registerIO", String("Registered ") + io->id());
 }
 
 void IORegistry::begin() {
   // Libère les IO existantes si begin() est appelé à nouveau
+  TraceRecorder::stop();
+  TracePlayer::close();
+  SelfCal::abort();
   for (auto io : _list) {
     delete io;
   }
   _list.clear();
   _map.clear();
+  // Les ordonnanceurs ADS1115 référencent les canaux : ils sont recréés
+  for (auto d : _i2cDevices) {
+    delete d->ads;
+    delete d->dac;
+    delete d;
+  }
+  _i2cDevices.clear();
+  _simOutputs.clear();
   // Charge la configuration et crée les IO
   auto& doc = ConfigStore::doc("io");
   JsonArray devices = doc["devices"].as<JsonArray>();
   for (JsonObject dev : devices) {
     String id    = dev["id"].as<String>();
     String drv   = dev["driver"].as<String>();
+    size_t before = _list.size();
     if (drv == "a0") {
       int bits = dev["bits"].as<int>();
       float vref = dev["vref"].as<float>();
@@ -72,89 +142,284 @@ void IORegistry::begin() {
       uint8_t addr = dev["i2c_addr"].as<uint8_t>();
       uint8_t channel = dev["channel"].as<uint8_t>();
       float pga = dev["pga"].as<float>();
-      registerIO(new IO_ADS1115(id, addr, channel, pga));
+      bool continuous = dev["mode"] == "continuous";
+      uint16_t rate = dev["data_rate"] | 128;
+      IO_ADS1115* io = new IO_ADS1115(id, addr, channel, pga, continuous, rate);
+      I2CDevice* d = findDevice("ads1115", addr);
+      if (!d) {
+        // Le débit retenu est celui du premier canal du composant
+        d = new I2CDevice();
+        d->driver = "ads1115";
+        d->address = addr;
+        Ads1115* ads = new Ads1115(addr);
+        ads->setDataRate(rate);
+        d->ads = new AdsScheduler(ads);
+        _i2cDevices.push_back(d);
+      }
+      io->attach(d->ads, &d->health);
+      registerIO(io);
     } else if (drv == "mcp4725") {
       uint8_t addr = dev["i2c_addr"].as<uint8_t>();
       int bits = dev["bits"].as<int>();
       float vref = dev["vref"].as<float>();
-      registerIO(new IO_MCP4725(id, addr, bits, vref));
+      IO_MCP4725* io = new IO_MCP4725(id, addr, bits, vref);
+      I2CDevice* d = findDevice("mcp4725", addr);
+      if (!d) {
+        d = new I2CDevice();
+        d->driver = "mcp4725";
+        d->address = addr;
+        d->dac = new Mcp4725(addr);
+        _i2cDevices.push_back(d);
+      }
+      io->attach(d->dac, &d->health);
+      registerIO(io);
     } else if (drv == "0_10v") {
-      registerIO(new IO_0_10V(id));
+      registerIO(new IO_0_10V(id, dev["full_scale"] | 10.0f));
+    } else if (drv == "sim") {
+      registerIO(createSim(id, dev));
+    } else if (drv == "sim_out") {
+      IO_SimOut* io = new IO_SimOut(id, dev["bits"] | 12, dev["vref"] | 3.3f);
+      io->setResponse(dev["gain"] | 1.0f, dev["offset"] | 0.0f, dev["bow"] | 0.0f,
+                      dev["settle_us"] | 0);
+      _simOutputs.push_back(io);
+      registerIO(io);
+    } else if (drv == "sim_loopback") {
+      IO_SimLoopback* io = createLoopback(id, dev);
+      if (io) registerIO(io);
+    } else if (drv == "replay") {
+      // Une entrée "replay" crée une IO par canal de la trace
+      String path = dev["trace"] | "";
+      if (TracePlayer::open(path)) {
+        for (const auto& ch : TracePlayer::channels()) {
+          registerIO(new IO_Replay(ch.id, ch.rawScale, ch.scale));
+        }
+      }
     } else {
       Logger::warn("IO", "begin", String("Unknown driver: ") + drv);
     }
+    if (!dev["calibration"].isNull() && _list.size() == before + 1) {
+      applyCalibration(_list.back(), dev["calibration"]);
+    }
+  }
+  // Sonde unique de chaque composant ; les absents seront repris par loop()
+  uint32_t now = millis();
+  for (auto d : _i2cDevices) {
+    bool ok = probeDevice(d);
+    d->health.probed(ok, now);
+    if (ok) {
+      Logger::info("IO", d->driver, String("Found at ") + hexAddress(d->address));
+    } else {
+      Logger::error("IO", d->driver, String("No answer at ") + hexAddress(d->address));
+    }
+  }
+  _snapshot.generation = 0;
+  _snapshot.tUs = 0;
+  _snapshot.codes.assign(_list.size(), 0);
+  _snapshot.stamps.assign(_list.size(), 0);
+}
+
+void IORegistry::loop() {
+  uint32_t now = millis();
+  for (auto d : _i2cDevices) {
+    if (!d->health.retryDue(now)) continue;
+    bool ok = probeDevice(d);
+    d->health.probed(ok, now);
+    if (!ok) continue;
+    Logger::info("IO", d->driver, String("Back online at ") + hexAddress(d->address));
+    for (auto io : _list) {
+      if (io->health() == &d->health) io->resync();
+    }
   }
 }
 
-IOBase* IORegistry::get(const String &id) {
+IOHandle IORegistry::resolve(const String &id) {
   auto it = _map.find(id);
   if (it != _map.end()) return it->second;
-  return nullptr;
+  return IO_INVALID;
+}
+
+void IORegistry::publish(IOHandle handle, int16_t code, uint32_t tUs) {
+  if (handle >= _snapshot.codes.size()) return;
+  _snapshot.codes[handle] = code;
+  _snapshot.stamps[handle] = tUs;
+}
+
+void IORegistry::commitSnapshot(uint32_t tUs) {
+  _snapshot.tUs = tUs;
+  _snapshot.generation++;
+}
+
+bool IORegistry::applyCalibration(IOBase* io, JsonVariantConst cfg) {
+  String error;
+  CalTable* cal = CalTable::compile(cfg, io->codeMin(), io->codeMax(), io->scale(),
+                                    !io->isInput(), error);
+  if (!cal) {
+    Logger::error("IO", "calibration", io->id() + ": " + error);
+    return false;
+  }
+  io->setCalibration(cal);
+  Logger::info("IO", "calibration", String("Compiled for ") + io->id());
+  return true;
 }
 
-std::vector<IOBase*> IORegistry::list() {
-  return _list;
+void IORegistry::driverStats(JsonObject& out) {
+  JsonArray ads = out["ads1115"].to<JsonArray>();
+  JsonArray dacs = out["mcp4725"].to<JsonArray>();
+  for (auto d : _i2cDevices) {
+    JsonObject o = d->ads ? ads.add<JsonObject>() : dacs.add<JsonObject>();
+    if (d->ads) {
+      d->ads->stats(o);
+    } else {
+      o["address"] = d->address;
+      o["transactions"] = d->dac->transactions();
+      o["updates"] = d->dac->updates();
+      o["skipped"] = d->dac->skipped();
+      o["errors"] = d->dac->errors();
+    }
+    JsonObject health = o["health"].to<JsonObject>();
+    d->health.stats(health);
+  }
 }
 
 /*
  * Implementations spécifiques des IO dérivées.  Ces méthodes
- * utilisent les bibliothèques Adafruit pour accéder aux
- * périphériques I2C.  Les appareils sont instanciés et mis en
- * cache dans des maps statiques afin de partager un pilote par
- * adresse I2C.
+ * utilisent les pilotes registre (Ads1115, Mcp4725) pour accéder aux
+ * périphériques I2C.  Les pilotes sont créés par IORegistry::begin()
+ * et partagés par adresse I2C.
  */
 
-float IO_ADS1115::readRaw() {
-  // Obtenir ou créer l'instance du convertisseur pour cette adresse
-  Adafruit_ADS1115 *ads;
-  auto it = _adsDevices.find(_address);
-  if (it == _adsDevices.end()) {
-    ads = new Adafruit_ADS1115();
-    if (!ads->begin(_address)) {
-      Logger::error("IO", "ADS1115", String("Failed to init ADS1115 at 0x") + String(_address, HEX));
-      delete ads;
-      ads = nullptr;
+void IO_ADS1115::attach(AdsScheduler* scheduler, DeviceHealth* health) {
+  _scheduler = scheduler;
+  _health = health;
+  _slot = scheduler->addChannel(_channel, _pga, _continuous);
+}
+
+int16_t IO_ADS1115::readCode() {
+  // Chemin bloquant : on attend le résultat au plus deux conversions
+  // au débit le plus lent.
+  if (!online() || !startConversion()) return 0;
+  int16_t code = 0;
+  uint32_t t0 = micros();
+  Collect state;
+  while ((state = collect(code)) == COLLECT_PENDING) {
+    if (micros() - t0 > 260000UL) {
+      _pending = false;
+      return 0;
     }
-    _adsDevices[_address] = ads;
-  } else {
-    ads = it->second;
+    yield();
   }
-  if (!ads) {
-    // Périphérique indisponible : retourner une mesure nulle pour éviter les crashs.
-    return 0.0f;
+  return state == COLLECT_READY ? code : 0;
+}
+
+bool IO_ADS1115::startConversion() {
+  if (!_scheduler) return false;
+  _scheduler->request(_slot);
+  _scheduler->service();
+  _pending = true;
+  return true;
+}
+
+IOBase::Collect IO_ADS1115::collect(int16_t &code) {
+  code = 0;
+  if (!_pending) return COLLECT_FAILED;
+  _scheduler->service();
+  bool ok = false;
+  if (!_scheduler->take(_slot, code, ok)) return COLLECT_PENDING;
+  _pending = false;
+  if (!ok) {
+    // Lecture I2C manquée : aucun échantillon plutôt qu'un faux zéro
+    code = 0;
+    if (_health->reportError(millis())) {
+      Logger::warn("IO", "ads1115", String("Offline after errors at 0x") + String(_address, HEX));
+    }
+    return COLLECT_FAILED;
   }
-  // Configurer le gain en fonction de la pleine échelle souhaitée
-  ads->setGain(pgaToGain(_pga));
-  // Lecture en mode single-ended : valeur 0..32767
-  int16_t code = ads->readADC_SingleEnded(_channel);
-  // Normaliser en fraction 0..1 (code max 32767)
-  float frac = static_cast<float>(code) / 32767.0f;
-  if (frac < 0.0f) frac = 0.0f;
-  if (frac > 1.0f) frac = 1.0f;
-  return frac;
+  _health->reportOk();
+  // Entrée single-ended : les codes négatifs ne sont que du bruit autour de 0
+  if (code < 0) code = 0;
+  return COLLECT_READY;
+}
+
+bool IO_Sim::captureBurst(int16_t* out, uint16_t count, uint32_t rateHz, bool fast,
+                          BurstInfo& info) {
+  // Rafale instantanée : le temps n'avance pas, l'intervalle est celui demandé
+  uint32_t rate = rateHz ? rateHz : _signal.rateHz();
+  _signal.fill(out, count, rate);
+  info.tStartUs = micros();
+  info.requestedRateHz = rateHz;
+  info.intervalUs = 1000000.0f / rate;
+  info.durationUs = static_cast<uint32_t>(info.intervalUs * count);
+  info.count = count;
+  info.fast = fast;
+  return true;
+}
+
+void IO_SimOut::writePercent(float percent) {
+  if (percent < 0.0f) percent = 0.0f;
+  if (percent > 100.0f) percent = 100.0f;
+  setCode(static_cast<uint16_t>(calibrate(static_cast<int32_t>(percent / 100.0f * _maxCode + 0.5f))));
+}
+
+size_t IO_SimOut::writeStream(const uint16_t* codes, size_t count) {
+  // Sortie instantanée : seul le dernier code de la suite subsiste
+  if (count) setCode(codes[count - 1] > _maxCode ? _maxCode : codes[count - 1]);
+  return count;
+}
+
+void IO_SimOut::setCode(uint16_t code) {
+  uint32_t now = micros();
+  _from = volts(now);
+  _code = code;
+  float x = code * _scale;
+  _to = _offset + _gain * x + _bow * x * (x - _vref) / _vref;
+  _changeUs = now;
+}
+
+float IO_SimOut::volts(uint32_t tUs) const {
+  uint32_t dt = tUs - _changeUs;
+  if (_settleUs == 0 || dt >= 20 * _settleUs) return _to;
+  return _to + (_from - _to) * expf(-static_cast<float>(dt) / _settleUs);
+}
+
+int16_t IO_SimLoopback::readCode() {
+  float v = _gain * _source->volts(micros()) + _offset;
+  if (_noise > 0.0f) {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    v += _noise * (static_cast<int32_t>(_seed) / 2147483648.0f);
+  }
+  int32_t code = static_cast<int32_t>(lroundf(v / _scale));
+  if (code < 0) code = 0;
+  if (code > 32767) code = 32767;
+  return static_cast<int16_t>(code);
 }
 
 void IO_MCP4725::writePercent(float percent) {
+  if (!online()) return;
   // Clamp du pourcentage 0–100
   if (percent < 0.0f) percent = 0.0f;
   if (percent > 100.0f) percent = 100.0f;
   float ratio = percent / 100.0f;
-  // Obtenir ou créer l'instance du DAC
-  Adafruit_MCP4725 *dac;
-  auto it = _dacDevices.find(_address);
-  if (it == _dacDevices.end()) {
-    dac = new Adafruit_MCP4725();
-    if (!dac->begin(_address)) {
-      Logger::error("IO", "MCP4725", String("Failed to init MCP4725 at 0x") + String(_address, HEX));
-    }
-    _dacDevices[_address] = dac;
-  } else {
-    dac = it->second;
-  }
   // Convertir en code 0..2^bits-1
   uint16_t maxCode = (1u << _bits) - 1;
-  uint16_t code = static_cast<uint16_t>(ratio * maxCode + 0.5f);
-  dac->setVoltage(code, false);
+  uint16_t code = static_cast<uint16_t>(calibrate(static_cast<int32_t>(ratio * maxCode + 0.5f)));
+  if (_device->write(code)) {
+    _health->reportOk();
+  } else if (_health->reportError(millis())) {
+    Logger::warn("IO", "mcp4725", String("Offline after errors at 0x") + String(_address, HEX));
+  }
+}
+
+size_t IO_MCP4725::writeStream(const uint16_t* codes, size_t count) {
+  if (!online()) return 0;
+  size_t sent = _device->writeStream(codes, count);
+  if (sent == count) {
+    _health->reportOk();
+  } else if (_health->reportError(millis())) {
+    Logger::warn("IO", "mcp4725", String("Offline after errors at 0x") + String(_address, HEX));
+  }
+  return sent;
 }
 
 void IO_0_10V::writePercent(float percent) {
@@ -163,6 +428,8 @@ void IO_0_10V::writePercent(float percent) {
   if (percent > 100.0f) percent = 100.0f;
   float ratio = percent / 100.0f;
   // Conversion en valeur PWM 0..1023 (10 bits) pour ESP8266
-  uint16_t pwm = static_cast<uint16_t>(ratio * 1023.0f + 0.5f);
+  uint16_t pwm = static_cast<uint16_t>(calibrate(static_cast<int32_t>(ratio * 1023.0f + 0.5f)));
+  if (pwm == _lastPwm) return;
+  _lastPwm = pwm;
   analogWrite(PIN_0_10V_OUT, pwm);
 }
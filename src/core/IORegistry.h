@@ -15,17 +15,118 @@
 #include <Arduino.h>
 #include <vector>
 #include <map>
+#include <ArduinoJson.h>
+
+#include "A0Burst.h"
+#include "AdsScheduler.h"
+#include "Calibration.h"
+#include "DeviceHealth.h"
+#include "Mcp4725.h"
+#include "SimSignal.h"
+
+/**
+ * Identifiant entier dense d'une IO : sa position dans
+ * IORegistry::list().  Il est résolu une seule fois à la configuration
+ * (IORegistry::resolve()) puis utilisé sur les chemins chauds à la
+ * place de l'identifiant texte.  Les handles sont invalidés par un
+ * nouvel appel à IORegistry::begin().
+ */
+typedef uint16_t IOHandle;
+static const IOHandle IO_INVALID = 0xFFFF;
 
 class IOBase {
 public:
   IOBase(const String &id) : _id(id) {}
-  virtual ~IOBase() {}
-  /** Lit la valeur brute (sans conversion en unité physique). */
-  virtual float readRaw() { return 0.0f; }
+  virtual ~IOBase() { delete _cal; }
+  /**
+   * Lit le code natif du convertisseur (entier signé 16 bits), de
+   * façon bloquante si nécessaire.  Hors du moteur d'acquisition.
+   */
+  virtual int16_t readCode() { return 0; }
+  /** Lit la valeur brute normalisée 0..1 (sans conversion en unité physique). */
+  float readRaw() { return readCode() * _rawScale; }
   /** Écrit un pourcentage (0–100%) sur la sortie (si applicable). */
   virtual void writePercent(float percent) { (void)percent; }
-  /** Retourne l'identifiant unique. */
-  String id() const { return _id; }
+  /**
+   * Envoie une suite de codes natifs à la sortie, aussi vite que le
+   * permet le bus (forme d'onde).  Retourne le nombre de codes écrits,
+   * 0 si la sortie ne gère pas ce mode.
+   */
+  virtual size_t writeStream(const uint16_t* codes, size_t count) {
+    (void)codes; (void)count;
+    return 0;
+  }
+  /** Indique si l'IO est une entrée échantillonnée par le moteur d'acquisition. */
+  virtual bool isInput() const { return false; }
+  /** Santé du composant I2C portant l'IO (nullptr si sans objet). */
+  virtual const DeviceHealth* health() const { return nullptr; }
+  /** false si le composant est hors ligne : l'IO n'est ni lue ni écrite. */
+  bool online() const {
+    const DeviceHealth* h = health();
+    return !h || h->online();
+  }
+  /** Abandonne toute conversion en cours (composant réinitialisé). */
+  virtual void resync() {}
+  /**
+   * Démarre une conversion sans en attendre le résultat.  Retourne
+   * false si elle ne peut pas démarrer maintenant (convertisseur
+   * occupé) ; l'appelant réessaiera plus tard.  Par défaut la lecture
+   * est instantanée et il n'y a rien à démarrer.
+   */
+  virtual bool startConversion() { return true; }
+  /** Issue d'un collect(). */
+  enum Collect : uint8_t {
+    COLLECT_PENDING,  ///< Résultat pas encore prêt, à redemander
+    COLLECT_READY,    ///< `code` contient un échantillon valide
+    COLLECT_FAILED    ///< Conversion perdue (erreur de bus, rien en cours) : pas d'échantillon
+  };
+  /** Récupère le code de la conversion démarrée.  Par défaut lit readCode(). */
+  virtual Collect collect(int16_t &code) { code = readCode(); return COLLECT_READY; }
+  /** Indique si l'IO sait capturer une rafale (captureBurst()). */
+  virtual bool supportsBurst() const { return false; }
+  /**
+   * Capture `count` codes consécutifs en une rafale bloquante, hors du
+   * moteur d'acquisition (voir A0Burst).  Retourne false si l'IO ne
+   * gère pas ce mode.
+   */
+  virtual bool captureBurst(int16_t* out, uint16_t count, uint32_t rateHz, bool fast,
+                            BurstInfo& info) {
+    (void)out; (void)count; (void)rateHz; (void)fast; (void)info;
+    return false;
+  }
+  /** Plus petit et plus grand code natif de l'IO. */
+  virtual int32_t codeMin() const { return -32768; }
+  virtual int32_t codeMax() const { return 32767; }
+  /** Installe la table d'étalonnage compilée (possédée par l'IO). */
+  void setCalibration(CalTable* cal) {
+    delete _cal;
+    _cal = cal;
+  }
+  bool calibrated() const { return _cal != nullptr; }
+  /** Retire la table d'étalonnage et la rend à l'appelant (nullptr si aucune). */
+  CalTable* takeCalibration() {
+    CalTable* cal = _cal;
+    _cal = nullptr;
+    return cal;
+  }
+  /**
+   * Applique l'étalonnage : code brut → code corrigé pour une entrée,
+   * code nominal → code à écrire pour une sortie.  Identité sans
+   * section "calibration".
+   */
+  int16_t calibrate(int32_t code) const {
+    return _cal ? _cal->apply(code) : static_cast<int16_t>(code);
+  }
+  /** Retourne l'identifiant unique (stocké une fois, jamais copié). */
+  const String& id() const { return _id; }
+  /** Facteur code → fraction 0..1 de la pleine échelle (précalculé). */
+  float rawScale() const { return _rawScale; }
+  /**
+   * Facteur code → volts (rawScale × vref × ratio), précalculé à la
+   * construction pour que les appareils convertissent leurs entiers
+   * en unité physique par une seule multiplication à l'affichage.
+   */
+  float scale() const { return _scale; }
   /**
    * Retourne la tension de référence associée à cette IO.  Par défaut
    * 1.0 pour signifier qu'il n'y a pas de conversion interne.  Les
@@ -42,23 +143,38 @@ public:
   virtual float getRatio() const { return 1.0f; }
 protected:
   String _id;
+  float _rawScale = 1.0f;
+  float _scale = 1.0f;
+  CalTable* _cal = nullptr;
+  /** Fixe les facteurs de conversion (à appeler depuis le constructeur dérivé). */
+  void setScale(float rawScale, float volts) {
+    _rawScale = rawScale;
+    _scale = rawScale * volts;
+  }
 };
 
 /**
- * Implémentation pour l'ADC interne A0.  Cette classe lit la valeur
- * brute sur la broche A0.  La conversion en tension ou autres
+ * Implémentation pour l'ADC interne A0.  Cette classe lit le code
+ * brut sur la broche A0.  La conversion en tension ou autres
  * grandeurs se fait au niveau des appareils (multimètre, scope).
  */
 class IO_A0 : public IOBase {
 public:
   IO_A0(const String &id, int bits, float vref, float ratio) :
-    IOBase(id), _bits(bits), _vref(vref), _ratio(ratio) {}
-  float readRaw() override {
-    int code = analogRead(A0);
-    // Normalisé 0..1 avant conversion; la conversion exacte sera
-    // appliquée par la formule du multimètre ou du scope.
-    return static_cast<float>(code) / ((1 << _bits) - 1);
+    IOBase(id), _bits(bits), _vref(vref), _ratio(ratio) {
+    setScale(1.0f / ((1 << _bits) - 1), _vref * _ratio);
   }
+  int16_t readCode() override {
+    return static_cast<int16_t>(analogRead(A0));
+  }
+  bool isInput() const override { return true; }
+  bool supportsBurst() const override { return true; }
+  bool captureBurst(int16_t* out, uint16_t count, uint32_t rateHz, bool fast,
+                    BurstInfo& info) override {
+    return A0Burst::capture(A0Adc::active(), out, count, rateHz, fast, info);
+  }
+  int32_t codeMin() const override { return 0; }
+  int32_t codeMax() const override { return (1 << _bits) - 1; }
   float getVref() const override { return _vref; }
   float getRatio() const override { return _ratio; }
 private:
@@ -68,47 +184,224 @@ private:
 };
 
 /**
- * Classe pour un canal ADC ADS1115.  Cette implémentation est un
- * squelette : l'intégration réelle du pilote I2C doit être faite
- * dans la méthode readRaw().  Sans pilote, cette méthode renvoie
- * simplement zéro.
+ * Entrée simulée (pilote "sim") : chaque conversion renvoie
+ * l'échantillon suivant d'un SimSignal, à la cadence virtuelle
+ * configurée.  Le code 32767 correspond à `range` volts.
+ */
+class IO_Sim : public IOBase {
+public:
+  IO_Sim(const String &id, float range) : IOBase(id), _range(range) {
+    setScale(1.0f / 32767.0f, _range);
+  }
+  SimSignal& signal() { return _signal; }
+  int16_t readCode() override { return _signal.next(); }
+  bool isInput() const override { return true; }
+  bool supportsBurst() const override { return true; }
+  bool captureBurst(int16_t* out, uint16_t count, uint32_t rateHz, bool fast,
+                    BurstInfo& info) override;
+  float getVref() const override { return _range; }
+private:
+  float _range;
+  SimSignal _signal;
+};
+
+/**
+ * Sortie simulée (pilote "sim_out") : mémorise le dernier code écrit
+ * et modélise la tension réellement produite, avec une erreur de
+ * gain, un décalage et une courbure (bow, maximale à mi-échelle) :
+ * v = offset + gain·x + bow·x·(x − vref)/vref, x étant la tension
+ * nominale du code.  Chaque changement s'établit selon un premier
+ * ordre de constante `settle_us`.  Sert de DAC aux bouclages simulés.
+ */
+class IO_SimOut : public IOBase {
+public:
+  IO_SimOut(const String &id, int bits, float vref) :
+    IOBase(id), _maxCode((1 << bits) - 1), _vref(vref) {
+    setScale(1.0f / _maxCode, _vref);
+  }
+  void writePercent(float percent) override;
+  size_t writeStream(const uint16_t* codes, size_t count) override;
+  int32_t codeMin() const override { return 0; }
+  int32_t codeMax() const override { return _maxCode; }
+  float getVref() const override { return _vref; }
+  void setResponse(float gain, float offset, float bow, uint32_t settleUs) {
+    _gain = gain;
+    _offset = offset;
+    _bow = bow;
+    _settleUs = settleUs;
+  }
+  uint16_t code() const { return _code; }
+  /** Tension de sortie à l'instant `tUs`. */
+  float volts(uint32_t tUs) const;
+private:
+  int32_t _maxCode;
+  float _vref;
+  float _gain = 1.0f;
+  float _offset = 0.0f;
+  float _bow = 0.0f;
+  uint32_t _settleUs = 0;
+  uint16_t _code = 0;
+  float _from = 0.0f;       ///< Tension au moment du dernier changement
+  float _to = 0.0f;         ///< Tension finale du code courant
+  uint32_t _changeUs = 0;
+  void setCode(uint16_t code);
+};
+
+/**
+ * Entrée simulée reliée à une IO_SimOut (pilote "sim_loopback") :
+ * mesure la tension de la sortie avec son propre gain et décalage,
+ * plus un bruit uniforme de ±`noise` volts.  Entrée single-ended, le
+ * code 32767 correspond à `range` volts.
+ */
+class IO_SimLoopback : public IOBase {
+public:
+  IO_SimLoopback(const String &id, float range, IO_SimOut* source) :
+    IOBase(id), _range(range), _source(source) {
+    setScale(1.0f / 32767.0f, _range);
+  }
+  void setResponse(float gain, float offset, float noise, uint32_t seed) {
+    _gain = gain;
+    _offset = offset;
+    _noise = noise;
+    _seed = seed ? seed : 1;
+  }
+  int16_t readCode() override;
+  bool isInput() const override { return true; }
+  int32_t codeMin() const override { return 0; }
+  float getVref() const override { return _range; }
+private:
+  float _range;
+  IO_SimOut* _source;
+  float _gain = 1.0f;
+  float _offset = 0.0f;
+  float _noise = 0.0f;
+  uint32_t _seed = 1;
+};
+
+/**
+ * Entrée rejouée depuis une trace (pilote "replay", voir Trace.h).
+ * Elle ne convertit rien : le moteur d'acquisition pousse directement
+ * les codes enregistrés.  Les facteurs d'échelle sont ceux de l'IO
+ * d'origine, copiés tels quels pour un rejeu exact.
+ */
+class IO_Replay : public IOBase {
+public:
+  IO_Replay(const String &id, float rawScale, float scale) : IOBase(id) {
+    _rawScale = rawScale;
+    _scale = scale;
+  }
+  bool isInput() const override { return true; }
+  bool startConversion() override { return false; }
+};
+
+/**
+ * Classe pour un canal ADC ADS1115.  Les canaux d'un même composant
+ * partagent un ordonnanceur AdsScheduler par adresse I2C (le débit
+ * retenu est celui du premier canal inscrit), qui sert leurs demandes
+ * en tourniquet.  L'ordonnanceur est créé et le composant sondé par
+ * IORegistry::begin(), jamais sur le chemin d'acquisition.  En mode
+ * continu le composant convertit en permanence au débit configuré ;
+ * en mode single-shot chaque demande lance une conversion.  Dans les
+ * deux cas collect() ne bloque jamais.
  */
 class IO_ADS1115 : public IOBase {
 public:
-  IO_ADS1115(const String &id, uint8_t address, uint8_t channel, float pga) :
-    IOBase(id), _address(address), _channel(channel), _pga(pga) {}
-  float readRaw() override;
+  IO_ADS1115(const String &id, uint8_t address, uint8_t channel, float pga,
+             bool continuous, uint16_t dataRate) :
+    IOBase(id), _address(address), _channel(channel), _pga(pga),
+    _continuous(continuous), _dataRate(dataRate) {
+    // Code 32767 = pleine échelle du gain retenu
+    setScale(1.0f / 32767.0f, Ads1115::fullScale(_pga));
+  }
+  /** Lecture bloquante (demande + attente du résultat), hors chemin d'acquisition. */
+  int16_t readCode() override;
+  bool isInput() const override { return true; }
+  bool startConversion() override;
+  Collect collect(int16_t &code) override;
+  /** Entrée single-ended : collect() ne rend jamais de code négatif. */
+  int32_t codeMin() const override { return 0; }
+  float getVref() const override { return Ads1115::fullScale(_pga); }
+  const DeviceHealth* health() const override { return _health; }
+  void resync() override { _pending = false; }
+  /** Inscrit le canal auprès de l'ordonnanceur de son composant. */
+  void attach(AdsScheduler* scheduler, DeviceHealth* health);
+  uint8_t address() const { return _address; }
+  uint16_t dataRate() const { return _dataRate; }
 private:
   uint8_t _address;
   uint8_t _channel;
   float _pga;
+  bool _continuous;
+  uint16_t _dataRate;
+  bool _pending = false;
+  AdsScheduler* _scheduler = nullptr;
+  DeviceHealth* _health = nullptr;
+  int _slot = -1;
 };
 
 /**
- * Classe pour une sortie analogique via MCP4725.  Ici on définit
- * simplement une fonction d'écriture de pourcentage, le pilote I2C
- * devant être ajouté dans writePercent().
+ * Classe pour une sortie analogique via MCP4725.  Les IO d'une même
+ * adresse partagent un pilote Mcp4725 (écriture rapide sur deux
+ * octets, codes identiques au précédent non réécrits), créé et sondé
+ * par IORegistry::begin().  Les écritures vers un composant hors
+ * ligne sont ignorées.
  */
 class IO_MCP4725 : public IOBase {
 public:
   IO_MCP4725(const String &id, uint8_t address, int bits, float vref) :
-    IOBase(id), _address(address), _bits(bits), _vref(vref) {}
+    IOBase(id), _address(address), _bits(bits), _vref(vref) {
+    setScale(1.0f / ((1 << _bits) - 1), _vref);
+  }
   void writePercent(float percent) override;
+  size_t writeStream(const uint16_t* codes, size_t count) override;
+  const DeviceHealth* health() const override { return _health; }
+  int32_t codeMin() const override { return 0; }
+  int32_t codeMax() const override { return (1 << _bits) - 1; }
+  void attach(Mcp4725* device, DeviceHealth* health) {
+    _device = device;
+    _health = health;
+  }
+  uint8_t address() const { return _address; }
 private:
   uint8_t _address;
   int _bits;
   float _vref;
+  Mcp4725* _device = nullptr;
+  DeviceHealth* _health = nullptr;
 };
 
 /**
  * Classe pour une sortie 0–10 V via module PWM→tension.  Le
  * pourcentage est converti en tension par la logique du module.  La
  * génération PWM doit être réalisée via analogWrite() ou un DAC.
+ * Le code est le rapport cyclique 0..1023, `fullScale` la tension
+ * nominale à 1023 (10 V) ; l'étalonnage corrige la non-linéarité du
+ * module.
  */
 class IO_0_10V : public IOBase {
 public:
-  IO_0_10V(const String &id) : IOBase(id) {}
+  IO_0_10V(const String &id, float fullScale = 10.0f) : IOBase(id) {
+    setScale(1.0f / 1023.0f, fullScale);
+  }
   void writePercent(float percent) override;
+  int32_t codeMin() const override { return 0; }
+  int32_t codeMax() const override { return 1023; }
+private:
+  int _lastPwm = -1;   ///< Dernier rapport cyclique appliqué
+};
+
+/**
+ * Instantané des dernières valeurs de toutes les IO.  Le moteur
+ * d'acquisition y publie chaque échantillon au moment où il le lit ;
+ * les consommateurs qui n'ont besoin que de la valeur courante (API
+ * /api/io, OLED, UDP) lisent l'instantané au lieu d'interroger le
+ * matériel.  Les tableaux sont indexés par IOHandle.
+ */
+struct IOSnapshot {
+  uint32_t generation = 0;        ///< Incrémenté à chaque tick publiant une valeur
+  uint32_t tUs = 0;               ///< Horodatage du dernier tick publié
+  std::vector<int16_t> codes;     ///< Dernier code natif de chaque IO
+  std::vector<uint32_t> stamps;   ///< Horodatage de chaque valeur (0 = jamais lue)
 };
 
 /**
@@ -118,14 +411,34 @@ class IORegistry {
 public:
   /** Initialise le registre en créant les IO définies dans la config. */
   static void begin();
-  /** Boucle d'entretien (actuellement vide). */
-  static void loop() {}
+  /** Boucle d'entretien : nouvelle sonde des composants hors ligne arrivés à échéance. */
+  static void loop();
+  /** Résout un identifiant en handle (à la configuration) ; IO_INVALID si inconnu. */
+  static IOHandle resolve(const String &id);
+  /** Retourne l'IO d'un handle en temps constant ; nullptr si invalide. */
+  static IOBase* at(IOHandle handle) {
+    return handle < _list.size() ? _list[handle] : nullptr;
+  }
   /** Retourne un pointeur vers une IO par son identifiant. */
-  static IOBase* get(const String &id);
-  /** Liste tous les IO sous forme d'un vecteur d'identifiants. */
-  static std::vector<IOBase*> list();
+  static IOBase* get(const String &id) { return at(resolve(id)); }
+  /** Liste toutes les IO, indexées par handle. */
+  static const std::vector<IOBase*>& list() { return _list; }
+  /** Dernier instantané publié. */
+  static const IOSnapshot& snapshot() { return _snapshot; }
+  /** Enregistre la valeur lue pour une IO (moteur d'acquisition). */
+  static void publish(IOHandle handle, int16_t code, uint32_t tUs);
+  /** Clôt le tick courant : horodate l'instantané et incrémente sa génération. */
+  static void commitSnapshot(uint32_t tUs);
+  /**
+   * Compile et installe la section "calibration" `cfg` sur `io`.
+   * Retourne false (table précédente conservée) si elle est invalide.
+   */
+  static bool applyCalibration(IOBase* io, JsonVariantConst cfg);
+  /** Statistiques et santé des pilotes partagés (ADS1115, MCP4725). */
+  static void driverStats(JsonObject& out);
 private:
   static std::vector<IOBase*> _list;
-  static std::map<String, IOBase*> _map;
+  static std::map<String, IOHandle> _map;
+  static IOSnapshot _snapshot;
   static void registerIO(IOBase* io);
 };
@@ -0,0 +1,67 @@
+/**
+ * @file Mcp4725.cpp
+ * @brief Implémentation du pilote MCP4725 en écriture rapide.
+ */
+
+#include "Mcp4725.h"
+#include "I2CBus.h"
+
+bool Mcp4725::begin() {
+  // Octet d'état puis registre DAC (code courant sur 12 bits)
+  uint8_t buf[3];
+  _lastValid = false;
+  if (!I2CBus::active().read(_address, buf, sizeof(buf))) return false;
+  _last = (static_cast<uint16_t>(buf[1]) << 4) | (buf[2] >> 4);
+  _lastValid = true;
+  return true;
+}
+
+void Mcp4725::packFast(uint16_t code, uint8_t* out) {
+  // C2 C1 = 00 (écriture rapide), PD1 PD0 = 00 (sortie active)
+  if (code > MAX_CODE) code = MAX_CODE;
+  out[0] = static_cast<uint8_t>(code >> 8);
+  out[1] = static_cast<uint8_t>(code & 0xFF);
+}
+
+bool Mcp4725::write(uint16_t code) {
+  if (code > MAX_CODE) code = MAX_CODE;
+  if (_lastValid && code == _last) {
+    _skipped++;
+    return true;
+  }
+  uint8_t buf[2];
+  packFast(code, buf);
+  _transactions++;
+  if (!I2CBus::active().write(_address, buf, sizeof(buf))) {
+    _errors++;
+    _lastValid = false;
+    return false;
+  }
+  _updates++;
+  _last = code;
+  _lastValid = true;
+  return true;
+}
+
+size_t Mcp4725::writeStream(const uint16_t* codes, size_t count) {
+  uint8_t buf[STREAM_CHUNK * 2];
+  size_t sent = 0;
+  while (sent < count) {
+    size_t n = count - sent;
+    if (n > STREAM_CHUNK) n = STREAM_CHUNK;
+    for (size_t i = 0; i < n; ++i) {
+      packFast(codes[sent + i], buf + 2 * i);
+    }
+    _transactions++;
+    if (!I2CBus::active().write(_address, buf, 2 * n)) {
+      _errors++;
+      _lastValid = false;
+      break;
+    }
+    sent += n;
+    _updates += n;
+    _last = codes[sent - 1] > MAX_CODE ? MAX_CODE : codes[sent - 1];
+    _lastValid = true;
+  }
+  return sent;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file Mcp4725.h
+ * @brief Pilote du DAC I2C MCP4725 en mode d'écriture rapide.
+ *
+ * La commande « write DAC register » de la bibliothèque Adafruit
+ * transmet trois octets par mise à jour.  Ce pilote utilise la
+ * commande rapide du composant (deux octets : bits de mise en veille
+ * et 12 bits de code) et n'écrit pas un code identique au dernier
+ * envoyé.  Pour produire une forme d'onde, writeStream() enchaîne
+ * plusieurs mots rapides dans une même transaction : la sortie est
+ * mise à jour à chaque mot, soit 18 bits d'horloge par échantillon
+ * (environ 22 kSPS à 400 kHz).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Mcp4725 {
+public:
+  static const uint16_t MAX_CODE = 4095;
+  /** Nombre de mots rapides par transaction de writeStream(). */
+  static const size_t STREAM_CHUNK = 16;
+
+  explicit Mcp4725(uint8_t address) : _address(address) {}
+
+  uint8_t address() const { return _address; }
+  /** Vérifie la présence du composant en lisant son registre d'état. */
+  bool begin();
+  /**
+   * Écrit un code 12 bits par la commande rapide.  Retourne true sans
+   * transaction si le code est celui déjà en sortie.
+   */
+  bool write(uint16_t code);
+  /**
+   * Écrit une suite de codes, par transactions de STREAM_CHUNK mots.
+   * Retourne le nombre de codes effectivement envoyés.
+   */
+  size_t writeStream(const uint16_t* codes, size_t count);
+  /** Dernier code écrit avec succès. */
+  uint16_t lastCode() const { return _last; }
+
+  /** Transactions I2C émises. */
+  uint32_t transactions() const { return _transactions; }
+  /** Mises à jour de la sortie (un mot rapide chacune). */
+  uint32_t updates() const { return _updates; }
+  /** Écritures évitées car identiques au code en sortie. */
+  uint32_t skipped() const { return _skipped; }
+  uint32_t errors() const { return _errors; }
+
+private:
+  uint8_t _address;
+  uint16_t _last = 0;
+  bool _lastValid = false;   ///< Code en sortie connu
+  uint32_t _transactions = 0;
+  uint32_t _updates = 0;
+  uint32_t _skipped = 0;
+  uint32_t _errors = 0;
+  static void packFast(uint16_t code, uint8_t* out);
+};
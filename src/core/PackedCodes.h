@@ -0,0 +1,83 @@
+/**
+ * @file PackedCodes.h
+ * @brief Suite de codes i16 compactée par différences et entiers variables.
+ *
+ * Chaque code est stocké comme sa différence avec le précédent (le
+ * premier avec 0), repliée en entier positif (zigzag : 0, −1, 1, −2...
+ * deviennent 0, 1, 2, 3...) puis écrite sur 7 bits par octet, bit de
+ * poids fort levé tant qu'il reste des bits.  Une différence de ±63
+ * codes tient en un octet, ±8191 en deux, et toute différence entre
+ * deux codes i16 en trois : un signal lent ou moyenné (convertisseur
+ * 10 bits, bruit de quelques codes) occupe à peu près un octet par
+ * échantillon au lieu de deux.  Le décodage est exact.
+ *
+ * La suite ne se lit que dans l'ordre, avec un Reader : elle est
+ * décodée au moment de la sérialiser, sans copie intermédiaire.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class PackedCodes {
+public:
+  /** Parcours séquentiel : next() rend les codes dans l'ordre d'écriture. */
+  class Reader {
+  public:
+    explicit Reader(const PackedCodes& codes) : _p(codes._bytes.data()) {}
+    int16_t next() {
+      uint32_t zigzag = 0;
+      uint8_t shift = 0;
+      uint8_t byte;
+      do {
+        byte = *_p++;
+        zigzag |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        shift += 7;
+      } while (byte & 0x80);
+      int32_t delta = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+      _prev = static_cast<int16_t>(_prev + delta);
+      return _prev;
+    }
+
+  private:
+    const uint8_t* _p;
+    int16_t _prev = 0;
+  };
+
+  /** Remplace le contenu par les `count` codes de `codes`. */
+  void pack(const int16_t* codes, size_t count) {
+    _bytes.clear();
+    _count = count;
+    int16_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+      int32_t delta = static_cast<int32_t>(codes[i]) - prev;
+      uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+      while (zigzag >= 0x80) {
+        _bytes.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+      }
+      _bytes.push_back(static_cast<uint8_t>(zigzag));
+      prev = codes[i];
+    }
+    // Pas de réserve gardée : seule la taille compactée reste sur le tas
+    _bytes.shrink_to_fit();
+  }
+  /** Décode les count() codes dans `out`. */
+  void unpack(int16_t* out) const {
+    Reader reader(*this);
+    for (size_t i = 0; i < _count; ++i) out[i] = reader.next();
+  }
+  void clear() {
+    std::vector<uint8_t>().swap(_bytes);
+    _count = 0;
+  }
+  size_t count() const { return _count; }
+  /** Octets occupés par la suite compactée. */
+  size_t bytes() const { return _bytes.size(); }
+
+private:
+  std::vector<uint8_t> _bytes;
+  size_t _count = 0;
+};
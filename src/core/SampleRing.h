@@ -0,0 +1,101 @@
+/**
+ * @file SampleRing.h
+ * @brief Tampon circulaire sans verrou pour les échantillons d'acquisition.
+ *
+ * Un seul producteur (le moteur d'acquisition) écrit dans l'anneau.
+ * Chaque consommateur (multimètre, oscilloscope, API...) possède son
+ * propre curseur de lecture et consomme donc l'anneau comme un canal
+ * SPSC indépendant.  Le producteur n'attend jamais : si un
+ * consommateur prend trop de retard, les échantillons écrasés sont
+ * comptabilisés comme perdus dans son curseur.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Curseur de lecture d'un consommateur.  `seq` est le numéro de
+ * séquence du prochain échantillon à lire, `dropped` le nombre
+ * d'échantillons perdus parce que le producteur a fait un tour
+ * complet de l'anneau.
+ */
+struct RingCursor {
+  uint32_t seq = 0;
+  uint32_t dropped = 0;
+};
+
+template <typename T, size_t N>
+class SampleRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SampleRing size must be a power of two");
+public:
+  static constexpr size_t capacity() { return N; }
+
+  /** Vide l'anneau (à n'appeler qu'en l'absence de lecteurs actifs). */
+  void clear() { _head.store(0, std::memory_order_release); }
+
+  /** Ajoute un élément ; écrase le plus ancien si l'anneau est plein. */
+  void push(const T &value) {
+    uint32_t h = _head.load(std::memory_order_relaxed);
+    _slots[h & (N - 1)] = value;
+    _head.store(h + 1, std::memory_order_release);
+  }
+
+  /** Numéro de séquence du prochain élément qui sera écrit. */
+  uint32_t head() const { return _head.load(std::memory_order_acquire); }
+
+  /** Copie le dernier élément écrit ; false si l'anneau est vide. */
+  bool latest(T &out) const {
+    uint32_t h = head();
+    if (h == 0) return false;
+    out = _slots[(h - 1) & (N - 1)];
+    return true;
+  }
+
+  /** Positionne un curseur sur le prochain élément à venir. */
+  void attach(RingCursor &cursor) const {
+    cursor.seq = head();
+    cursor.dropped = 0;
+  }
+
+  /**
+   * Lit au plus `max` éléments depuis le curseur.  Un élément dont
+   * l'emplacement a pu être réécrit pendant la copie est ignoré et
+   * compté comme perdu.
+   * @return nombre d'éléments copiés dans `out`.
+   */
+  size_t read(RingCursor &cursor, T *out, size_t max) const {
+    uint32_t h = head();
+    uint32_t avail = h - cursor.seq;
+    if (avail >= N) {
+      // Le producteur a fait le tour : on saute au plus ancien élément sûr.
+      uint32_t skip = avail - (N - 1);
+      cursor.dropped += skip;
+      cursor.seq += skip;
+      avail = N - 1;
+    }
+    size_t n = avail < max ? avail : max;
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = _slots[(cursor.seq + i) & (N - 1)];
+    }
+    // Vérifie après copie qu'aucun emplacement lu n'a été réécrit.
+    uint32_t after = head();
+    size_t valid = n;
+    if (after - cursor.seq >= N) {
+      uint32_t lost = (after - cursor.seq) - (N - 1);
+      if (lost > n) lost = n;
+      // Les `lost` premiers éléments copiés peuvent être corrompus.
+      for (size_t i = lost; i < n; ++i) out[i - lost] = out[i];
+      valid = n - lost;
+      cursor.dropped += lost;
+    }
+    cursor.seq += n;
+    return valid;
+  }
+
+private:
+  T _slots[N];
+  std::atomic<uint32_t> _head{0};
+};
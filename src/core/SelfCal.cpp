@@ -0,0 +1,275 @@
+/**
+ * @file SelfCal.cpp
+ * @brief Implémentation de l'auto-étalonnage par bouclage.
+ */
+
+#include "SelfCal.h"
+#include "ConfigStore.h"
+#include "Logger.h"
+#include "Trace.h"
+
+#include <math.h>
+
+SelfCal::State SelfCal::_state = SelfCal::IDLE;
+IOHandle SelfCal::_output = IO_INVALID;
+IOHandle SelfCal::_input = IO_INVALID;
+String SelfCal::_outputId;
+String SelfCal::_inputId;
+IOBase* SelfCal::_target = nullptr;
+CalTable* SelfCal::_previous = nullptr;
+Acquisition::Reader SelfCal::_reader;
+uint8_t SelfCal::_points = 0;
+uint8_t SelfCal::_averages = 0;
+uint32_t SelfCal::_settleUs = 0;
+bool SelfCal::_referenceInput = true;
+bool SelfCal::_save = true;
+uint8_t SelfCal::_index = 0;
+uint32_t SelfCal::_writeUs = 0;
+int32_t SelfCal::_sum = 0;
+uint8_t SelfCal::_count = 0;
+uint32_t SelfCal::_startMs = 0;
+uint32_t SelfCal::_durationMs = 0;
+String SelfCal::_error;
+float SelfCal::_gain = 0.0f;
+float SelfCal::_offset = 0.0f;
+float SelfCal::_nonlinearity = 0.0f;
+uint8_t SelfCal::_used = 0;
+std::vector<int32_t> SelfCal::_codes;
+std::vector<float> SelfCal::_measured;
+
+bool SelfCal::start(const String& outputId, const String& inputId,
+                    JsonVariantConst options, String& error) {
+  if (_state == RUNNING) {
+    error = "calibration already running";
+    return false;
+  }
+  if (TracePlayer::active()) {
+    error = "trace replay active";
+    return false;
+  }
+  IOHandle output = IORegistry::resolve(outputId);
+  IOHandle input = IORegistry::resolve(inputId);
+  IOBase* out = IORegistry::at(output);
+  IOBase* in = IORegistry::at(input);
+  if (!out || out->isInput()) {
+    error = String("unknown output ") + outputId;
+    return false;
+  }
+  if (!in || !in->isInput()) {
+    error = String("unknown input ") + inputId;
+    return false;
+  }
+  if (!out->online() || !in->online()) {
+    error = "device offline";
+    return false;
+  }
+  int points = options["points"] | 33;
+  int averages = options["averages"] | 4;
+  uint32_t settleUs = options["settle_us"] | 2000;
+  String reference = options["reference"] | "input";
+  if (points < 2 || points > MAX_POINTS || averages < 1 || averages > 64 ||
+      settleUs > 1000000UL) {
+    error = "invalid points, averages or settle_us";
+    return false;
+  }
+  if (reference != "input" && reference != "output") {
+    error = "reference must be \"input\" or \"output\"";
+    return false;
+  }
+  if (!Acquisition::attach(input, _reader)) {
+    error = String("input not sampled: ") + inputId;
+    return false;
+  }
+
+  _output = output;
+  _input = input;
+  _outputId = outputId;
+  _inputId = inputId;
+  _points = static_cast<uint8_t>(points);
+  _averages = static_cast<uint8_t>(averages);
+  _settleUs = settleUs;
+  _referenceInput = reference == "input";
+  _save = options["save"] | true;
+  // La cible est balayée sans correction ; la référence garde la sienne
+  _target = _referenceInput ? out : in;
+  _previous = _target->takeCalibration();
+  _codes.assign(_points, 0);
+  _measured.assign(_points, 0.0f);
+  _error = "";
+  _used = 0;
+  _startMs = millis();
+  _durationMs = 0;
+  _state = RUNNING;
+  Logger::info("CAL", "start", String("Sweeping ") + outputId + " on " + inputId + " (" +
+               _points + " points, reference " + reference + ")");
+  writePoint(0);
+  return true;
+}
+
+void SelfCal::writePoint(uint8_t index) {
+  IOBase* out = IORegistry::at(_output);
+  int32_t maxCode = out->codeMax();
+  int32_t code = (index * maxCode + (_points - 1) / 2) / (_points - 1);
+  _index = index;
+  _codes[index] = code;
+  _sum = 0;
+  _count = 0;
+  // Pourcentage exact du code : writePercent() l'arrondit au même code
+  out->writePercent(code * 100.0f / maxCode);
+  _writeUs = micros();
+}
+
+void SelfCal::loop() {
+  if (_state != RUNNING) return;
+  if (!IORegistry::at(_output)->online() || !IORegistry::at(_input)->online()) {
+    fail("device offline");
+    return;
+  }
+  Sample batch[16];
+  size_t n;
+  while ((n = Acquisition::read(_reader, batch, 16)) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      // Conversion démarrée avant l'établissement : ignorée
+      if (static_cast<int32_t>(batch[i].tUs - _writeUs) < static_cast<int32_t>(_settleUs)) {
+        continue;
+      }
+      _sum += batch[i].code;
+      if (++_count < _averages) continue;
+      uint8_t done = _index;
+      float mean = static_cast<float>(_sum) / _count;
+      if (done + 1 >= _points) {
+        _measured[done] = mean;
+        finish();
+        return;
+      }
+      // Le code suivant s'établit pendant l'enregistrement du point ;
+      // les échantillons restants du lot sont antérieurs à l'écriture
+      writePoint(done + 1);
+      _measured[done] = mean;
+    }
+  }
+  if (micros() - _writeUs > POINT_TIMEOUT_US + _settleUs) {
+    fail("no sample from input");
+  }
+}
+
+void SelfCal::finish() {
+  IOBase* out = IORegistry::at(_output);
+  IOBase* in = IORegistry::at(_input);
+  out->writePercent(0.0f);
+  _durationMs = millis() - _startMs;
+
+  // Couples [x, y] de la section "calibration" de la cible, hors saturation
+  int32_t lo = in->codeMin() > 0 ? in->codeMin() : 0;
+  int32_t hi = in->codeMax();
+  std::vector<float> xs;
+  std::vector<float> ys;
+  for (uint8_t k = 0; k < _points; ++k) {
+    if (_measured[k] <= lo + 1 || _measured[k] >= hi - 1) continue;
+    float requested = _codes[k] * out->scale();
+    float measured = _measured[k] * in->scale();
+    float x = _referenceInput ? requested : measured;
+    float y = _referenceInput ? measured : requested;
+    // Une entrée bruitée peut lire deux fois la même tension
+    if (!xs.empty() && x <= xs.back()) continue;
+    xs.push_back(x);
+    ys.push_back(y);
+  }
+  _used = static_cast<uint8_t>(xs.size());
+  if (_used < 2) {
+    fail("input saturated on all points");
+    return;
+  }
+
+  // Droite des moindres carrés, pour information
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (size_t k = 0; k < xs.size(); ++k) {
+    sx += xs[k];
+    sy += ys[k];
+    sxx += static_cast<double>(xs[k]) * xs[k];
+    sxy += static_cast<double>(xs[k]) * ys[k];
+  }
+  double det = _used * sxx - sx * sx;
+  _gain = det != 0 ? static_cast<float>((_used * sxy - sx * sy) / det) : 1.0f;
+  _offset = static_cast<float>((sy - _gain * sx) / _used);
+  _nonlinearity = 0.0f;
+  for (size_t k = 0; k < xs.size(); ++k) {
+    float r = fabsf(ys[k] - (_gain * xs[k] + _offset));
+    if (r > _nonlinearity) _nonlinearity = r;
+  }
+
+  JsonDocument cal;
+  JsonArray points = cal["points"].to<JsonArray>();
+  for (size_t k = 0; k < xs.size(); ++k) {
+    JsonArray p = points.add<JsonArray>();
+    p.add(roundf(xs[k] * 10000.0f) / 10000.0f);
+    p.add(roundf(ys[k] * 10000.0f) / 10000.0f);
+  }
+  cal["gain"] = _gain;
+  cal["offset"] = _offset;
+  cal["nonlinearity"] = _nonlinearity;
+  cal["source"] = "loopback";
+  cal["reference"] = _referenceInput ? in->id() : out->id();
+  if (!IORegistry::applyCalibration(_target, cal.as<JsonVariantConst>())) {
+    fail("compilation failed");
+    return;
+  }
+  delete _previous;
+  _previous = nullptr;
+  if (_save) {
+    JsonArray devices = ConfigStore::doc("io")["devices"].as<JsonArray>();
+    for (JsonObject dev : devices) {
+      if (_target->id() == dev["id"].as<const char*>()) {
+        dev["calibration"] = cal;
+        ConfigStore::requestSave("io");
+        break;
+      }
+    }
+  }
+  _state = DONE;
+  _codes.clear();
+  _measured.clear();
+  Logger::info("CAL", "finish", _target->id() + ": " + _used + " points in " + _durationMs +
+               " ms, gain " + String(_gain, 4) + ", offset " + String(_offset, 4) +
+               " V, nonlinearity " + String(_nonlinearity, 4) + " V");
+}
+
+void SelfCal::fail(const String& error) {
+  abort();
+  _state = FAILED;
+  _error = error;
+  Logger::error("CAL", "sweep", error);
+}
+
+void SelfCal::abort() {
+  if (_state != RUNNING) return;
+  _target->setCalibration(_previous);
+  _previous = nullptr;
+  IOBase* out = IORegistry::at(_output);
+  if (out) out->writePercent(0.0f);
+  _durationMs = millis() - _startMs;
+  _codes.clear();
+  _measured.clear();
+  _state = IDLE;
+}
+
+void SelfCal::status(JsonObject& out) {
+  static const char* names[] = {"idle", "running", "done", "failed"};
+  out["state"] = names[_state];
+  out["output"] = _outputId;
+  out["input"] = _inputId;
+  out["reference"] = _referenceInput ? "input" : "output";
+  out["points"] = _points;
+  if (_state == RUNNING) {
+    out["point"] = _index;
+    out["elapsed_ms"] = millis() - _startMs;
+    return;
+  }
+  out["duration_ms"] = _durationMs;
+  if (_state == FAILED) out["error"] = _error;
+  if (_state != DONE) return;
+  out["used"] = _used;
+  out["gain"] = _gain;
+  out["offset"] = _offset;
+  out["nonlinearity"] = _nonlinearity;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file SelfCal.h
+ * @brief Auto-étalonnage par bouclage d'une sortie sur une entrée.
+ *
+ * La sortie (MCP4725, module 0–10 V) est reliée à une entrée
+ * échantillonnée (A0, canal ADS1115) puis balayée en `points` codes
+ * régulièrement espacés.  Pour chaque code, on attend `settle_us`
+ * puis on moyenne `averages` échantillons du moteur d'acquisition,
+ * lus avec un curseur comme le ferait l'oscilloscope : le balayage ne
+ * démarre aucune conversion et ne gêne pas les autres canaux.
+ *
+ * Le balayage est pipeliné : dès que le dernier échantillon d'un
+ * point arrive, le code suivant est écrit, puis le point est
+ * enregistré pendant que la sortie s'établit et que le moteur
+ * poursuit ses conversions.  Un point ne coûte donc que le temps
+ * d'établissement et de ses conversions ; 33 points prennent une
+ * fraction de seconde sur A0 et environ une seconde à 128 SPS.
+ *
+ * Un seul bouclage ne permet pas de séparer l'erreur de la sortie de
+ * celle de l'entrée : l'une des deux sert de référence ("reference")
+ * et garde son étalonnage pendant le balayage.
+ * - "input" (défaut) : l'entrée fait foi ; la section "calibration"
+ *   de la sortie reçoit les couples [tension demandée, tension
+ *   mesurée] ;
+ * - "output" : la sortie fait foi ; la section de l'entrée reçoit les
+ *   couples [tension lue, tension demandée].
+ * Étalonner d'abord une sortie contre une entrée précise (ADS1115),
+ * puis une autre entrée (A0) contre cette sortie, corrige ainsi les
+ * deux chemins.  La section produite contient les points (gain,
+ * décalage et non-linéarité compris), ainsi que le gain, le décalage
+ * et l'écart maximal à la droite pour information.  Elle est compilée
+ * immédiatement et, sauf "save": false, écrite dans io.json par
+ * ConfigStore.  Les points où l'entrée sature sont écartés.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "Acquisition.h"
+#include "IORegistry.h"
+
+class SelfCal {
+public:
+  static const uint8_t MAX_POINTS = CalTable::NODES;
+  /** Délai maximal sans échantillon utile avant abandon. */
+  static const uint32_t POINT_TIMEOUT_US = 2000000UL;
+
+  /**
+   * Démarre un balayage de `outputId` mesuré sur `inputId`.  Options :
+   * points (33), averages (4), settle_us (2000), reference ("input"),
+   * save (true).  Retourne false et renseigne `error` si la demande
+   * est invalide.
+   */
+  static bool start(const String& outputId, const String& inputId,
+                    JsonVariantConst options, String& error);
+  /** Avance le balayage (cadence des périphériques). */
+  static void loop();
+  /** Interrompt le balayage et restaure l'étalonnage précédent. */
+  static void abort();
+  static bool running() { return _state == RUNNING; }
+  /** true si `io` est balayée ou mesurée : les autres écrivains s'abstiennent. */
+  static bool holds(IOHandle io) {
+    return _state == RUNNING && (io == _output || io == _input);
+  }
+  /** État, progression et résultat pour l'API REST. */
+  static void status(JsonObject& out);
+
+private:
+  enum State : uint8_t { IDLE, RUNNING, DONE, FAILED };
+  static State _state;
+  static IOHandle _output;
+  static IOHandle _input;
+  static String _outputId;
+  static String _inputId;
+  static IOBase* _target;      ///< IO dont l'étalonnage est produit
+  static CalTable* _previous;  ///< Étalonnage retiré à la cible pendant le balayage
+  static Acquisition::Reader _reader;
+  static uint8_t _points;
+  static uint8_t _averages;
+  static uint32_t _settleUs;
+  static bool _referenceInput;
+  static bool _save;
+  static uint8_t _index;       ///< Point en cours
+  static uint32_t _writeUs;    ///< Écriture du code du point en cours
+  static int32_t _sum;
+  static uint8_t _count;
+  static uint32_t _startMs;
+  static uint32_t _durationMs;
+  static String _error;
+  static float _gain;
+  static float _offset;
+  static float _nonlinearity;
+  static uint8_t _used;        ///< Points retenus (hors saturation)
+  static std::vector<int32_t> _codes;   ///< Code écrit pour chaque point
+  static std::vector<float> _measured;  ///< Code moyen lu pour chaque point
+
+  static void writePoint(uint8_t index);
+  static void finish();
+  static void fail(const String& error);
+};
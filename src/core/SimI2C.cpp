@@ -0,0 +1,168 @@
+/**
+ * @file SimI2C.cpp
+ * @brief Implémentation du bus I2C simulé et du modèle ADS1115.
+ */
+
+#include "SimI2C.h"
+#include "Ads1115.h"
+
+void SimI2CBus::account(size_t len) {
+  _transactions++;
+  _busyUs += static_cast<uint32_t>((len + 1) * 9ULL * 1000000ULL / _clockHz);
+}
+
+bool SimI2CBus::recover() {
+  _recoveries++;
+  _stuck = false;
+  return true;
+}
+
+bool SimI2CBus::write(uint8_t addr, const uint8_t* data, size_t len) {
+  account(len);
+  auto it = _devices.find(addr);
+  if (_stuck || it == _devices.end() || !it->second->onWrite(data, len)) {
+    _nacks++;
+    return false;
+  }
+  _bytes += len;
+  return true;
+}
+
+bool SimI2CBus::read(uint8_t addr, uint8_t* data, size_t len) {
+  account(len);
+  auto it = _devices.find(addr);
+  if (_stuck || it == _devices.end() || !it->second->onRead(data, len)) {
+    _nacks++;
+    return false;
+  }
+  _bytes += len;
+  return true;
+}
+
+SimAds1115::SimAds1115() {
+  // Valeurs de reset du composant (datasheet)
+  _regs[Ads1115::REG_CONVERSION] = 0x0000;
+  _regs[Ads1115::REG_CONFIG]     = 0x8583;
+  _regs[Ads1115::REG_LO_THRESH]  = 0x8000;
+  _regs[Ads1115::REG_HI_THRESH]  = 0x7FFF;
+}
+
+uint32_t SimAds1115::periodUs() const {
+  static const uint16_t rates[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+  uint8_t dr = (_regs[Ads1115::REG_CONFIG] >> Ads1115::CFG_DR_SHIFT) & 0x7;
+  return 1000000UL / rates[dr];
+}
+
+int16_t SimAds1115::sample(uint32_t tUs) const {
+  static const float scales[8] = {6.144f, 4.096f, 2.048f, 1.024f, 0.512f, 0.256f, 0.256f, 0.256f};
+  uint16_t cfg = _regs[Ads1115::REG_CONFIG];
+  uint8_t mux = (cfg >> Ads1115::CFG_MUX_SHIFT) & 0x7;
+  uint8_t pga = (cfg >> Ads1115::CFG_PGA_SHIFT) & 0x7;
+  // Seules les entrées single-ended (MUX 100..111) sont modélisées.
+  if (mux < 4) return 0;
+  uint8_t channel = mux - 4;
+  float volts = _signal ? _signal(channel, tUs) : _inputs[channel];
+  float code = volts / scales[pga] * 32768.0f;
+  if (code > 32767.0f) code = 32767.0f;
+  if (code < -32768.0f) code = -32768.0f;
+  return static_cast<int16_t>(code);
+}
+
+void SimAds1115::update() {
+  if (!_converting) return;
+  uint32_t now = micros();
+  uint32_t period = periodUs();
+  if (_regs[Ads1115::REG_CONFIG] & Ads1115::CFG_MODE_SINGLE) {
+    if (now - _startUs >= period) {
+      _regs[Ads1115::REG_CONVERSION] = static_cast<uint16_t>(sample(_startUs + period));
+      _regs[Ads1115::REG_CONFIG] |= Ads1115::CFG_OS;
+      _converting = false;
+      _conversions++;
+    }
+    return;
+  }
+  uint32_t index = (now - _startUs) / period;
+  if (index > _lastIndex) {
+    _conversions += index - _lastIndex;
+    _lastIndex = index;
+    _regs[Ads1115::REG_CONVERSION] = static_cast<uint16_t>(sample(_startUs + index * period));
+  }
+}
+
+bool SimAds1115::onWrite(const uint8_t* data, size_t len) {
+  if (len < 1) return false;
+  _pointer = data[0] & 0x3;
+  if (len < 3) return true;
+  uint16_t value = (static_cast<uint16_t>(data[1]) << 8) | data[2];
+  if (_pointer == Ads1115::REG_CONVERSION) return true;
+  if (_pointer != Ads1115::REG_CONFIG) {
+    _regs[_pointer] = value;
+    return true;
+  }
+  update();
+  _configWrites++;
+  bool single = (value & Ads1115::CFG_MODE_SINGLE) != 0;
+  if (single) {
+    if (value & Ads1115::CFG_OS) {
+      _regs[Ads1115::REG_CONFIG] = value & ~Ads1115::CFG_OS;
+      _converting = true;
+      _startUs = micros();
+    } else {
+      _regs[Ads1115::REG_CONFIG] = value | Ads1115::CFG_OS;
+      _converting = false;
+    }
+  } else {
+    _regs[Ads1115::REG_CONFIG] = value & ~Ads1115::CFG_OS;
+    _converting = true;
+    _startUs = micros();
+    _lastIndex = 0;
+  }
+  return true;
+}
+
+bool SimAds1115::onRead(uint8_t* data, size_t len) {
+  update();
+  uint16_t value = _regs[_pointer];
+  if (len >= 1) data[0] = static_cast<uint8_t>(value >> 8);
+  if (len >= 2) data[1] = static_cast<uint8_t>(value & 0xFF);
+  return true;
+}
+
+bool SimMcp4725::onWrite(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    uint8_t cmd = data[i] >> 6;
+    if (cmd == 0) {
+      // Écriture rapide : PD1 PD0 D11..D8 puis D7..D0
+      if (i + 2 > len) return false;
+      _powerDown = (data[i] >> 4) & 0x3;
+      _code = (static_cast<uint16_t>(data[i] & 0x0F) << 8) | data[i + 1];
+      _updates++;
+      _fastUpdates++;
+      i += 2;
+    } else if (cmd == 1) {
+      // Write DAC register (C2 C1 C0 = 010 ou 011 avec EEPROM)
+      if (i + 3 > len) return false;
+      _powerDown = (data[i] >> 1) & 0x3;
+      _code = (static_cast<uint16_t>(data[i + 1]) << 4) | (data[i + 2] >> 4);
+      _updates++;
+      i += 3;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SimMcp4725::onRead(uint8_t* data, size_t len) {
+  // État (RDY, POR, PD) puis registre DAC sur deux octets
+  uint8_t regs[3] = {
+    static_cast<uint8_t>(0xC0 | (_powerDown << 1)),
+    static_cast<uint8_t>(_code >> 4),
+    static_cast<uint8_t>((_code & 0x0F) << 4)
+  };
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = i < sizeof(regs) ? regs[i] : 0;
+  }
+  return true;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file SimI2C.h
+ * @brief Bus I2C simulé et modèles de registres des composants.
+ *
+ * Ces classes permettent d'exécuter les pilotes I2C de MiniLabo sur
+ * un PC : le SimI2CBus remplace Wire (voir I2CBus::setActive()) et
+ * route chaque transaction vers le modèle attaché à l'adresse visée.
+ * Le temps simulé est celui de micros().
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+
+#include "I2CBus.h"
+
+/** Composant esclave simulé. */
+class SimI2CDevice {
+public:
+  virtual ~SimI2CDevice() {}
+  virtual bool onWrite(const uint8_t* data, size_t len) = 0;
+  virtual bool onRead(uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * Bus simulé : route les transactions et compte le trafic.  Le temps
+ * d'occupation est estimé à 9 bits par octet (adresse comprise) à la
+ * fréquence fixée par setClock().  setStuck() simule un esclave qui
+ * maintient SDA basse : toutes les transactions échouent jusqu'au
+ * prochain recover().
+ */
+class SimI2CBus : public I2CBus {
+public:
+  void attach(uint8_t addr, SimI2CDevice* device) { _devices[addr] = device; }
+  void detach(uint8_t addr) { _devices.erase(addr); }
+  bool write(uint8_t addr, const uint8_t* data, size_t len) override;
+  bool read(uint8_t addr, uint8_t* data, size_t len) override;
+  void setClock(uint32_t hz) override { _clockHz = hz ? hz : 100000; }
+  bool recover() override;
+  bool sdaHeld() override { return _stuck; }
+
+  void setStuck(bool stuck) { _stuck = stuck; }
+  uint32_t clockHz() const { return _clockHz; }
+  uint32_t transactions() const { return _transactions; }
+  uint32_t bytes() const { return _bytes; }
+  uint32_t nacks() const { return _nacks; }
+  uint32_t recoveries() const { return _recoveries; }
+  /** Temps de bus cumulé estimé en µs. */
+  uint32_t busyUs() const { return _busyUs; }
+  void resetCounters() { _transactions = _bytes = _nacks = _recoveries = _busyUs = 0; }
+
+private:
+  std::map<uint8_t, SimI2CDevice*> _devices;
+  uint32_t _clockHz = 100000;
+  bool _stuck = false;
+  uint32_t _transactions = 0;
+  uint32_t _bytes = 0;
+  uint32_t _nacks = 0;
+  uint32_t _recoveries = 0;
+  uint32_t _busyUs = 0;
+  void account(size_t len);
+};
+
+/**
+ * Modèle de la carte de registres d'un ADS1115 : pointeur de
+ * registre, configuration, conversion, seuils.  Les conversions
+ * single-shot et continues respectent le débit programmé.  La tension
+ * de chaque entrée est fixée par setInput() ou fournie par une
+ * fonction du temps (setSignal()).
+ */
+class SimAds1115 : public SimI2CDevice {
+public:
+  typedef float (*SignalFn)(uint8_t channel, uint32_t tUs);
+
+  SimAds1115();
+  void setInput(uint8_t channel, float volts) { _inputs[channel & 0x3] = volts; }
+  void setSignal(SignalFn fn) { _signal = fn; }
+
+  bool onWrite(const uint8_t* data, size_t len) override;
+  bool onRead(uint8_t* data, size_t len) override;
+
+  uint16_t config() const { return _regs[1]; }
+  /** Nombre d'écritures du registre de configuration. */
+  uint32_t configWrites() const { return _configWrites; }
+  /** Nombre de conversions terminées. */
+  uint32_t conversions() const { return _conversions; }
+
+private:
+  uint16_t _regs[4];
+  uint8_t _pointer = 0;
+  float _inputs[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  SignalFn _signal = nullptr;
+  bool _converting = false;
+  uint32_t _startUs = 0;
+  uint32_t _lastIndex = 0;    ///< Dernière conversion continue publiée
+  uint32_t _configWrites = 0;
+  uint32_t _conversions = 0;
+
+  uint32_t periodUs() const;
+  int16_t sample(uint32_t tUs) const;
+  void update();
+};
+
+/**
+ * Modèle du DAC MCP4725 : commandes rapides (mots de deux octets,
+ * éventuellement enchaînés dans une transaction) et « write DAC
+ * register » sur trois octets.  Chaque mot décodé met à jour la
+ * sortie.
+ */
+class SimMcp4725 : public SimI2CDevice {
+public:
+  bool onWrite(const uint8_t* data, size_t len) override;
+  bool onRead(uint8_t* data, size_t len) override;
+
+  /** Code 12 bits en sortie. */
+  uint16_t code() const { return _code; }
+  /** Mises à jour de la sortie, toutes commandes confondues. */
+  uint32_t updates() const { return _updates; }
+  /** Mises à jour reçues en commande rapide. */
+  uint32_t fastUpdates() const { return _fastUpdates; }
+
+private:
+  uint16_t _code = 0;
+  uint8_t _powerDown = 0;
+  uint32_t _updates = 0;
+  uint32_t _fastUpdates = 0;
+};
@@ -0,0 +1,122 @@
+/**
+ * @file SimSignal.cpp
+ * @brief Implémentation du générateur de signaux simulés.
+ */
+
+#include "SimSignal.h"
+
+#include <LittleFS.h>
+#include <math.h>
+
+bool SimSignal::parseWaveform(const String& name, Waveform& out) {
+  if (name == "sine") out = SINE;
+  else if (name == "square") out = SQUARE;
+  else if (name == "noise") out = NOISE;
+  else if (name == "ramp") out = RAMP;
+  else if (name == "file") out = FILE_DATA;
+  else return false;
+  return true;
+}
+
+uint32_t SimSignal::phaseStep(float freqHz, uint32_t rateHz) {
+  if (rateHz == 0 || freqHz <= 0.0f) return 0;
+  double step = static_cast<double>(freqHz) / rateHz * 4294967296.0;
+  // Au-delà de la moitié de la cadence le signal se replie : on borne
+  if (step > 2147483648.0) step = 2147483648.0;
+  return static_cast<uint32_t>(step + 0.5);
+}
+
+void SimSignal::configure(Waveform wave, float freqHz, uint32_t rateHz,
+                          int32_t amplitude, int32_t offset, uint32_t seed) {
+  _wave = wave;
+  _freqHz = freqHz;
+  _rateHz = rateHz ? rateHz : 1;
+  _amplitude = amplitude;
+  _offset = offset;
+  _seed = seed ? seed : 1;   // xorshift32 reste bloqué sur 0
+  _step = phaseStep(_freqHz, _rateHz);
+  reset();
+}
+
+bool SimSignal::loadFile(const String& path, float voltsPerCode) {
+  _file.clear();
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+  String line;
+  for (;;) {
+    int c = f.read();
+    if (c >= 0 && c != '\n') {
+      line += static_cast<char>(c);
+      continue;
+    }
+    line.trim();
+    if (line.length() > 0 && line[0] != '#') {
+      float volts = line.toFloat();
+      int32_t code = static_cast<int32_t>(lroundf(volts / voltsPerCode));
+      if (code > 32767) code = 32767;
+      if (code < -32768) code = -32768;
+      _file.push_back(static_cast<int16_t>(code));
+    }
+    line = String();
+    if (c < 0) break;
+  }
+  f.close();
+  reset();
+  return !_file.empty();
+}
+
+void SimSignal::reset() {
+  _phase = 0;
+  _noise = _seed;
+  _index = 0;
+}
+
+int16_t SimSignal::sample(uint32_t phase, uint32_t& noise, uint32_t index) const {
+  int32_t v;
+  switch (_wave) {
+    case SINE:
+      v = static_cast<int32_t>(lroundf(_amplitude * sinf(phase * (2.0f * static_cast<float>(PI) / 4294967296.0f))));
+      break;
+    case SQUARE:
+      v = phase < 0x80000000UL ? _amplitude : -_amplitude;
+      break;
+    case RAMP:
+      // -A à +A sur une période
+      v = static_cast<int32_t>((static_cast<int64_t>(_amplitude) * (static_cast<int64_t>(phase >> 15) - 65536)) / 65536);
+      break;
+    case NOISE:
+      noise ^= noise << 13;
+      noise ^= noise >> 17;
+      noise ^= noise << 5;
+      // Uniforme sur [-A, +A]
+      v = static_cast<int32_t>((static_cast<int64_t>(_amplitude) * (static_cast<int64_t>(noise >> 16) - 32768)) / 32768);
+      break;
+    case FILE_DATA:
+      v = _file.empty() ? 0 : _file[index % _file.size()];
+      break;
+    default:
+      v = 0;
+      break;
+  }
+  v += _offset;
+  if (v > 32767) v = 32767;
+  if (v < -32768) v = -32768;
+  return static_cast<int16_t>(v);
+}
+
+int16_t SimSignal::next() {
+  int16_t code = sample(_phase, _noise, _index);
+  _phase += _step;
+  _index++;
+  return code;
+}
+
+void SimSignal::fill(int16_t* out, uint16_t count, uint32_t rateHz) const {
+  uint32_t step = phaseStep(_freqHz, rateHz ? rateHz : _rateHz);
+  uint32_t phase = _phase;
+  uint32_t noise = _noise;
+  for (uint16_t i = 0; i < count; ++i) {
+    out[i] = sample(phase, noise, _index + i);
+    phase += step;
+  }
+}
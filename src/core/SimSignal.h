@@ -0,0 +1,68 @@
+/**
+ * @file SimSignal.h
+ * @brief Générateur de signaux déterministes du pilote "sim".
+ *
+ * Le pilote "sim" de l'IORegistry remplace un convertisseur par un
+ * signal calculé (sinus, carré, bruit, rampe) ou relu depuis un
+ * fichier.  Le signal est défini en échantillons et non en temps
+ * réel : le n-ième code produit correspond à l'instant n / rate_hz,
+ * quelle que soit la vitesse à laquelle on l'interroge.  Deux
+ * exécutions de même configuration produisent donc exactement les
+ * mêmes codes, sur la carte comme sur PC (environnement native).
+ *
+ * La phase est un accumulateur 32 bits (synthèse numérique directe) ;
+ * le bruit est un xorshift32 initialisé par "seed".  Les fichiers sont
+ * des textes à une valeur en volts par ligne (première colonne d'un
+ * CSV, lignes commençant par '#' ignorées), relus en boucle.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+class SimSignal {
+public:
+  enum Waveform : uint8_t { SINE, SQUARE, NOISE, RAMP, FILE_DATA };
+
+  /** Décode "sine", "square", "noise", "ramp" ou "file" ; false si inconnu. */
+  static bool parseWaveform(const String& name, Waveform& out);
+
+  /**
+   * Configure le signal : fréquence en Hz pour une cadence virtuelle
+   * `rateHz`, amplitude crête et décalage en codes.
+   */
+  void configure(Waveform wave, float freqHz, uint32_t rateHz,
+                 int32_t amplitude, int32_t offset, uint32_t seed);
+  /** Charge un fichier de valeurs en volts ; `voltsPerCode` fixe la conversion. */
+  bool loadFile(const String& path, float voltsPerCode);
+  /** Revient au premier échantillon (phase, graine, position fichier). */
+  void reset();
+  /** Code de l'échantillon courant puis passage au suivant. */
+  int16_t next();
+  /**
+   * Remplit `out` de `count` codes à la cadence `rateHz` sans modifier
+   * la séquence principale (rafale de l'oscilloscope).
+   */
+  void fill(int16_t* out, uint16_t count, uint32_t rateHz) const;
+
+  uint32_t rateHz() const { return _rateHz; }
+  uint32_t produced() const { return _index; }
+  size_t fileLength() const { return _file.size(); }
+
+private:
+  Waveform _wave = SINE;
+  float _freqHz = 0.0f;
+  uint32_t _rateHz = 1000;
+  int32_t _amplitude = 0;
+  int32_t _offset = 0;
+  uint32_t _seed = 1;
+  uint32_t _step = 0;      ///< Incrément de phase par échantillon (2^32 = une période)
+  uint32_t _phase = 0;
+  uint32_t _noise = 1;
+  uint32_t _index = 0;     ///< Échantillons produits depuis reset()
+  std::vector<int16_t> _file;
+
+  static uint32_t phaseStep(float freqHz, uint32_t rateHz);
+  int16_t sample(uint32_t phase, uint32_t& noise, uint32_t index) const;
+};
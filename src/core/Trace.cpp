@@ -0,0 +1,226 @@
+/**
+ * @file Trace.cpp
+ * @brief Implémentation de l'enregistrement et du rejeu de traces.
+ */
+
+#include "Trace.h"
+#include "Logger.h"
+
+#include <string.h>
+
+static const char TRACE_MAGIC[4] = {'M', 'L', 'T', 'R'};
+
+static void putU32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putF32(uint8_t* p, float f) {
+  uint32_t v;
+  memcpy(&v, &f, sizeof(v));
+  putU32(p, v);
+}
+
+static float getF32(const uint8_t* p) {
+  uint32_t v = getU32(p);
+  float f;
+  memcpy(&f, &v, sizeof(f));
+  return f;
+}
+
+bool TraceRecorder::_active = false;
+File TraceRecorder::_file;
+String TraceRecorder::_path;
+std::vector<int16_t> TraceRecorder::_index;
+uint8_t TraceRecorder::_buffer[TraceRecorder::BUFFER_SIZE];
+size_t TraceRecorder::_used = 0;
+uint32_t TraceRecorder::_lastUs = 0;
+uint32_t TraceRecorder::_records = 0;
+uint32_t TraceRecorder::_dropped = 0;
+uint32_t TraceRecorder::_bytes = 0;
+
+bool TraceRecorder::start(const String& path) {
+  stop();
+  int slash = path.lastIndexOf('/');
+  if (slash > 0) LittleFS.mkdir(path.substring(0, slash));
+  _file = LittleFS.open(path, "w");
+  if (!_file) {
+    Logger::error("TRACE", "start", String("Cannot create ") + path);
+    return false;
+  }
+  const std::vector<IOBase*>& ios = IORegistry::list();
+  _index.assign(ios.size(), -1);
+  std::vector<IOHandle> inputs;
+  for (size_t h = 0; h < ios.size() && inputs.size() < 255; ++h) {
+    if (!ios[h]->isInput()) continue;
+    _index[h] = static_cast<int16_t>(inputs.size());
+    inputs.push_back(static_cast<IOHandle>(h));
+  }
+  _lastUs = 0;
+  uint8_t head[6];
+  memcpy(head, TRACE_MAGIC, 4);
+  head[4] = VERSION;
+  head[5] = static_cast<uint8_t>(inputs.size());
+  _bytes = _file.write(head, sizeof(head));
+  for (IOHandle h : inputs) {
+    IOBase* io = ios[h];
+    uint8_t len = static_cast<uint8_t>(io->id().length() > 255 ? 255 : io->id().length());
+    uint8_t scales[8];
+    putF32(scales, io->rawScale());
+    putF32(scales + 4, io->scale());
+    _bytes += _file.write(&len, 1);
+    _bytes += _file.write(reinterpret_cast<const uint8_t*>(io->id().c_str()), len);
+    _bytes += _file.write(scales, sizeof(scales));
+  }
+  _path = path;
+  _used = 0;
+  _records = 0;
+  _dropped = 0;
+  _active = true;
+  Logger::info("TRACE", "start", String("Recording ") + inputs.size() + " channels to " + path);
+  return true;
+}
+
+void TraceRecorder::loop() {
+  if (!_active || _used == 0) return;
+  _bytes += _file.write(_buffer, _used);
+  _used = 0;
+}
+
+void TraceRecorder::stop() {
+  if (!_active) return;
+  loop();
+  _file.close();
+  _active = false;
+  Logger::info("TRACE", "stop", String("Recorded ") + _records + " samples (" + _bytes +
+               " bytes, " + _dropped + " dropped) to " + _path);
+}
+
+void TraceRecorder::stats(JsonObject& out) {
+  out["recording"] = _active;
+  out["path"] = _path;
+  out["samples"] = _records;
+  out["bytes"] = _bytes + _used;
+  out["dropped"] = _dropped;
+  out["replaying"] = TracePlayer::active();
+  out["replayed"] = TracePlayer::replayed();
+}
+
+bool TraceReader::readByte(uint8_t& b) {
+  if (_pos == _len) {
+    _len = _file.read(_buf, sizeof(_buf));
+    _pos = 0;
+    if (_len == 0) return false;
+  }
+  b = _buf[_pos++];
+  return true;
+}
+
+bool TraceReader::readBytes(uint8_t* out, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (!readByte(out[i])) return false;
+  }
+  return true;
+}
+
+bool TraceReader::open(const String& path) {
+  close();
+  _file = LittleFS.open(path, "r");
+  if (!_file) return false;
+  uint8_t head[6];
+  if (!readBytes(head, sizeof(head)) || memcmp(head, TRACE_MAGIC, 4) != 0 ||
+      head[4] != TraceRecorder::VERSION) {
+    close();
+    return false;
+  }
+  _lastUs = 0;
+  for (uint8_t i = 0; i < head[5]; ++i) {
+    uint8_t len;
+    char id[256];
+    uint8_t scales[8];
+    if (!readByte(len) || !readBytes(reinterpret_cast<uint8_t*>(id), len) ||
+        !readBytes(scales, sizeof(scales))) {
+      close();
+      return false;
+    }
+    id[len] = 0;
+    _channels.push_back({String(id), getF32(scales), getF32(scales + 4)});
+  }
+  return true;
+}
+
+void TraceReader::close() {
+  _file.close();
+  _channels.clear();
+  _pos = 0;
+  _len = 0;
+}
+
+bool TraceReader::next(TraceRecord& out) {
+  uint8_t channel;
+  if (!readByte(channel)) return false;
+  uint32_t dt = 0;
+  uint8_t shift = 0;
+  uint8_t b;
+  do {
+    if (!readByte(b) || shift > 28) return false;
+    dt |= static_cast<uint32_t>(b & 0x7F) << shift;
+    shift += 7;
+  } while (b & 0x80);
+  uint8_t code[2];
+  if (!readBytes(code, 2) || channel >= _channels.size()) return false;
+  _lastUs += dt;
+  out.channel = channel;
+  out.tUs = _lastUs;
+  out.code = static_cast<int16_t>(code[0] | (code[1] << 8));
+  return true;
+}
+
+TraceReader TracePlayer::_reader;
+bool TracePlayer::_active = false;
+bool TracePlayer::_started = false;
+bool TracePlayer::_hasPending = false;
+TraceRecord TracePlayer::_pending;
+uint32_t TracePlayer::_offsetUs = 0;
+uint32_t TracePlayer::_replayed = 0;
+
+bool TracePlayer::open(const String& path) {
+  close();
+  if (!_reader.open(path)) {
+    Logger::error("TRACE", "replay", String("Invalid trace ") + path);
+    return false;
+  }
+  _active = true;
+  _hasPending = _reader.next(_pending);
+  Logger::info("TRACE", "replay", String("Replaying ") + _reader.channels().size() +
+               " channels from " + path);
+  return true;
+}
+
+void TracePlayer::close() {
+  _reader.close();
+  _active = false;
+  _started = false;
+  _hasPending = false;
+  _replayed = 0;
+}
+
+bool TracePlayer::due(uint32_t nowUs, TraceRecord& out) {
+  if (!_hasPending) return false;
+  if (!_started) {
+    _offsetUs = nowUs - _pending.tUs;
+    _started = true;
+  }
+  if (static_cast<int32_t>(nowUs - (_pending.tUs + _offsetUs)) < 0) return false;
+  out = _pending;
+  _hasPending = _reader.next(_pending);
+  _replayed++;
+  return true;
+}
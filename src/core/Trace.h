@@ -0,0 +1,162 @@
+/**
+ * @file Trace.h
+ * @brief Enregistrement et rejeu des échantillons d'acquisition.
+ *
+ * Pour reproduire hors ligne un problème observé sur le terrain, le
+ * moteur d'acquisition peut écrire chaque échantillon (code natif et
+ * horodatage) dans une trace binaire sur LittleFS.  La trace est
+ * ensuite rejouée à la place du matériel : les IO "replay" de
+ * l'IORegistry reprennent les identifiants et facteurs d'échelle
+ * enregistrés, et le moteur pousse les échantillons dans ses anneaux
+ * à leur horodatage d'origine.  Multimètre, oscilloscope et émetteur
+ * UDP reçoivent ainsi exactement les mêmes codes ; sur PC, sous
+ * horloge virtuelle (environnement native), une heure de capture se
+ * rejoue en quelques secondes.
+ *
+ * Format (petit-boutiste) :
+ * - en-tête : "MLTR", version (u8), nombre de canaux (u8), puis pour
+ *   chaque canal : longueur de l'identifiant (u8), identifiant,
+ *   rawScale (f32), scale (f32) ;
+ * - enregistrements : canal (u8, index dans l'en-tête), écart en µs
+ *   depuis l'enregistrement précédent (varint LEB128, horodatage
+ *   complet pour le premier), code (i16),
+ *   soit 4 octets par échantillon si l'écart est inférieur à 128 µs
+ *   (canaux d'un même tick), 5 jusqu'à 16 ms.
+ *
+ * L'enregistreur n'écrit que dans un tampon RAM depuis
+ * Acquisition::loop() ; loop() le vide vers la flash depuis la cadence
+ * des périphériques.  Un tampon plein perd les échantillons suivants
+ * (compteur "dropped") plutôt que de bloquer l'acquisition.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <vector>
+
+#include "IORegistry.h"
+
+/** Canal décrit dans l'en-tête d'une trace. */
+struct TraceChannel {
+  String id;
+  float rawScale;
+  float scale;
+};
+
+/** Échantillon relu dans une trace. */
+struct TraceRecord {
+  uint8_t channel;   ///< Index dans l'en-tête
+  uint32_t tUs;      ///< Horodatage d'origine
+  int16_t code;
+};
+
+class TraceRecorder {
+public:
+  static const uint8_t VERSION = 1;
+  static const size_t BUFFER_SIZE = 1024;
+  /** Taille maximale d'un enregistrement (canal, varint 32 bits, code). */
+  static const size_t MAX_RECORD = 8;
+
+  /**
+   * Ouvre `path` et écrit l'en-tête des IO d'entrée de l'IORegistry.
+   * Retourne false si le fichier ne peut pas être créé.
+   */
+  static bool start(const String& path);
+  /** Vide le tampon et ferme la trace. */
+  static void stop();
+  /** Vide le tampon vers la flash (cadence des périphériques). */
+  static void loop();
+  static bool active() { return _active; }
+
+  /** Ajoute un échantillon au tampon (Acquisition::loop(), sans E/S). */
+  static void record(IOHandle handle, uint32_t tUs, int16_t code) {
+    if (!_active || handle >= _index.size() || _index[handle] < 0) return;
+    if (BUFFER_SIZE - _used < MAX_RECORD) {
+      _dropped++;
+      return;
+    }
+    uint8_t* p = _buffer + _used;
+    *p++ = static_cast<uint8_t>(_index[handle]);
+    uint32_t dt = tUs - _lastUs;
+    _lastUs = tUs;
+    while (dt >= 0x80) {
+      *p++ = static_cast<uint8_t>(dt | 0x80);
+      dt >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(dt);
+    *p++ = static_cast<uint8_t>(code);
+    *p++ = static_cast<uint8_t>(static_cast<uint16_t>(code) >> 8);
+    _used = p - _buffer;
+    _records++;
+  }
+
+  /** État de l'enregistrement pour l'API REST. */
+  static void stats(JsonObject& out);
+
+private:
+  static bool _active;
+  static File _file;
+  static String _path;
+  static std::vector<int16_t> _index;   ///< Index de canal de chaque handle (-1 si non enregistré)
+  static uint8_t _buffer[BUFFER_SIZE];
+  static size_t _used;
+  static uint32_t _lastUs;
+  static uint32_t _records;
+  static uint32_t _dropped;
+  static uint32_t _bytes;
+};
+
+/** Lecture séquentielle d'une trace. */
+class TraceReader {
+public:
+  /** Ouvre une trace et lit son en-tête ; false si absente ou invalide. */
+  bool open(const String& path);
+  void close();
+  const std::vector<TraceChannel>& channels() const { return _channels; }
+  /** Lit l'enregistrement suivant ; false en fin de trace. */
+  bool next(TraceRecord& out);
+
+private:
+  File _file;
+  std::vector<TraceChannel> _channels;
+  uint32_t _lastUs = 0;
+  uint8_t _buf[256];
+  size_t _pos = 0;
+  size_t _len = 0;
+  bool readByte(uint8_t& b);
+  bool readBytes(uint8_t* out, size_t n);
+};
+
+/**
+ * Rejeu d'une trace par le moteur d'acquisition.  Ouvert par
+ * IORegistry::begin() pour un équipement "replay" ; lorsqu'il est
+ * actif, Acquisition::loop() ne démarre plus de conversion et pousse
+ * les échantillons de la trace dont l'heure est venue, décalés pour
+ * que le premier coïncide avec le début du rejeu.
+ */
+class TracePlayer {
+public:
+  static bool open(const String& path);
+  static void close();
+  static bool active() { return _active; }
+  /** true lorsque tous les échantillons ont été rejoués. */
+  static bool finished() { return _active && !_hasPending; }
+  static const std::vector<TraceChannel>& channels() { return _reader.channels(); }
+  /**
+   * Échantillon suivant si son heure (décalée) est atteinte à `nowUs`.
+   * Le premier appel fixe le décalage entre la trace et l'horloge.
+   */
+  static bool due(uint32_t nowUs, TraceRecord& out);
+  static uint32_t replayed() { return _replayed; }
+
+private:
+  static TraceReader _reader;
+  static bool _active;
+  static bool _started;
+  static bool _hasPending;
+  static TraceRecord _pending;
+  static uint32_t _offsetUs;
+  static uint32_t _replayed;
+};
@@ -22,43 +22,62 @@ void DMM::begin() {
     String mode = ch["mode"].as<String>();
     uint8_t decimals = ch["decimals"].as<uint8_t>();
     size_t window = ch["filter_window"].as<size_t>();
-    IOBase* io = IORegistry::get(source);
-    if (!io) {
+    IOHandle io = IORegistry::resolve(source);
+    if (io == IO_INVALID) {
       Logger::warn("DMM", "begin", String("Unknown IO for channel ") + name + ": " + source);
       continue;
     }
     Channel c;
     c.name = name;
     c.io = io;
+    if (!Acquisition::attach(io, c.reader)) {
+      Logger::warn("DMM", "begin", String("IO is not sampled: ") + source);
+      continue;
+    }
     c.mode = mode;
     c.decimals = decimals;
     c.window = window < 1 ? 1 : window;
     c.buffer.reserve(c.window);
-    c.sum = 0.0f;
+    c.sum = 0;
     c.last = 0.0f;
+    c.analyze = mode == "THD";
+    if (c.analyze) c.harmonics.configure(ch["harmonics"] | 5, ch["harmonic_cycles"] | 10);
     _channels.push_back(c);
     Logger::info("DMM", "begin", String("Channel ") + name + " -> " + source);
   }
 }
 
 void DMM::loop() {
+  // Consomme les échantillons produits par le moteur d'acquisition
+  // depuis le dernier appel, par lots pour limiter la pile utilisée.
+  static const size_t BATCH = 16;
+  Sample samples[BATCH];
   for (auto &ch : _channels) {
-    float raw = ch.io->readRaw();
-    // Conversion simple en tension DC (vref * ratio)
-    float value = raw * ch.io->getVref() * ch.io->getRatio();
-    // Mise à jour du filtre moyenne glissante
-    if (ch.buffer.size() < ch.window) {
-      ch.buffer.push_back(value);
-      ch.sum += value;
-    } else {
-      // retirer la plus ancienne
-      ch.sum -= ch.buffer[0];
-      // décaler les éléments
-      ch.buffer.erase(ch.buffer.begin());
-      ch.buffer.push_back(value);
-      ch.sum += value;
+    IOBase* io = IORegistry::at(ch.io);
+    if (!io) continue;
+    size_t n;
+    while ((n = Acquisition::read(ch.reader, samples, BATCH)) > 0) {
+      for (size_t i = 0; i < n; ++i) {
+        int16_t value = samples[i].code;
+        if (ch.analyze) ch.harmonics.push(value);
+        // Mise à jour du filtre moyenne glissante sur les codes bruts
+        if (ch.buffer.size() < ch.window) {
+          ch.buffer.push_back(value);
+          ch.sum += value;
+        } else {
+          // retirer la plus ancienne
+          ch.sum -= ch.buffer[0];
+          // décaler les éléments
+          ch.buffer.erase(ch.buffer.begin());
+          ch.buffer.push_back(value);
+          ch.sum += value;
+        }
+      }
+    }
+    if (!ch.buffer.empty()) {
+      // Conversion unique en tension DC (vref * ratio) de la moyenne
+      ch.last = static_cast<float>(ch.sum) / ch.buffer.size() * io->scale();
     }
-    ch.last = ch.sum / ch.buffer.size();
   }
 }
 
@@ -67,6 +86,17 @@ void DMM::values(JsonObject& out) {
     // Formatage avec nombre de décimales configuré
     char buf[32];
     dtostrf(ch.last, 0, ch.decimals, buf);
+    if (ch.analyze) {
+      const HarmonicAnalyzer::Result& r = ch.harmonics.result();
+      if (r.valid) {
+        dtostrf(r.thd * 100.0f, 0, ch.decimals, buf);
+      } else {
+        strcpy(buf, "---");
+      }
+      IOBase* io = IORegistry::at(ch.io);
+      JsonObject harmonics = out["harmonics"][ch.name].to<JsonObject>();
+      ch.harmonics.toJson(harmonics, Acquisition::rateHz(ch.io), io ? io->scale() : 0.0f);
+    }
     out[ch.name] = String(buf);
   }
 }
\ No newline at end of file
@@ -6,6 +6,13 @@
  * applique une conversion simple en tension DC.  Les autres modes
  * (RMS, frÃ©quence, courant) sont Ã  implÃ©menter ultÃ©rieurement.  Les
  * valeurs lissÃ©es sont retournÃ©es sous forme de chaÃ®ne formatÃ©e.
+ *
+ * En mode "THD", le canal alimente un HarmonicAnalyzer ("harmonics" :
+ * nombre d'harmoniques aprÃ¨s la fondamentale, 5 par dÃ©faut,
+ * "harmonic_cycles" : pÃ©riodes par bloc, 10 par dÃ©faut) : la valeur
+ * affichÃ©e est le THD en pourcentage, et values() publie l'analyse
+ * complÃ¨te (fondamentale, THD, THD+N, SINAD, harmoniques en dBc) sous
+ * "harmonics".
  */
 
 #pragma once
@@ -14,6 +21,8 @@
 #include <vector>
 #include <ArduinoJson.h>
 #include "core/IORegistry.h"
+#include "core/Acquisition.h"
+#include "core/HarmonicAnalyzer.h"
 
 class DMM {
 public:
@@ -26,13 +35,16 @@ public:
 private:
   struct Channel {
     String name;
-    IOBase* io;
+    IOHandle io;
+    Acquisition::Reader reader;
     String mode;
     uint8_t decimals;
     size_t window;
-    std::vector<float> buffer;
-    float sum;
+    std::vector<int16_t> buffer;   ///< Codes bruts de la fenêtre de lissage
+    int32_t sum;                   ///< Somme entière des codes de la fenêtre
     float last;
+    bool analyze;                  ///< Mode "THD"
+    HarmonicAnalyzer harmonics;
   };
   static std::vector<Channel> _channels;
 };
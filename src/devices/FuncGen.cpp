@@ -6,8 +6,9 @@
 #include "FuncGen.h"
 #include "core/ConfigStore.h"
 #include "core/Logger.h"
+#include "core/SelfCal.h"
 
-IOBase* FuncGen::_target = nullptr;
+IOHandle FuncGen::_target = IO_INVALID;
 float FuncGen::_freq = 50.0f;
 float FuncGen::_amp = 0.5f;    // amplitude 0..1
 float FuncGen::_offset = 0.0f; // offset 0..1
@@ -22,15 +23,15 @@ void FuncGen::begin() {
   _offset = doc["offset"].as<float>() / 100.0f;
   _wave = doc["wave"].as<String>();
   _start = millis();
-  _target = IORegistry::get(targetId);
-  if (!_target) {
+  _target = IORegistry::resolve(targetId);
+  if (_target == IO_INVALID) {
     Logger::warn("FUNC", "begin", String("Unknown target IO: ") + targetId);
   }
 }
 
 void FuncGen::updateTarget(const String& id, float freq, float amp, float off, const String& wave) {
-  _target = IORegistry::get(id);
-  if (!_target) {
+  _target = IORegistry::resolve(id);
+  if (_target == IO_INVALID) {
     Logger::warn("FUNC", "updateTarget", String("Unknown target: ") + id);
   }
   _freq = freq;
@@ -49,7 +50,9 @@ void FuncGen::updateTarget(const String& id, float freq, float amp, float off, c
 }
 
 void FuncGen::loop() {
-  if (!_target) return;
+  IOBase* target = IORegistry::at(_target);
+  // La sortie est réservée pendant un auto-étalonnage
+  if (!target || SelfCal::holds(_target)) return;
   float t = (millis() - _start) / 1000.0f;
   float x = 0.0f;
   if (_wave == "sine") {
@@ -67,5 +70,5 @@ void FuncGen::loop() {
   if (y < 0.0f) y = 0.0f;
   if (y > 1.0f) y = 1.0f;
   // Convert to percent for writePercent()
-  _target->writePercent(y * 100.0f);
+  target->writePercent(y * 100.0f);
 }
\ No newline at end of file
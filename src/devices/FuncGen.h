@@ -21,7 +21,7 @@ public:
   /** Met à jour la configuration via l'API REST (appel depuis WebServer). */
   static void updateTarget(const String& id, float freq, float amp, float off, const String& wave);
 private:
-  static IOBase* _target;
+  static IOHandle _target;
   static float _freq;
   static float _amp;
   static float _offset;
@@ -1,6 +1,6 @@
 /**
  * @file Scope.cpp
- * @brief Implémentation minimale de l'oscilloscope virtuel.
+ * @brief Implémentation de l'oscilloscope virtuel.
  */
 
 #include "Scope.h"
@@ -8,8 +8,70 @@
 #include "core/Logger.h"
 
 #include <ArduinoJson.h>
+#include <math.h>
+#include <string.h>
+
+namespace {
+  void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+  }
+
+  void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    putU16(out, static_cast<uint16_t>(v));
+    putU16(out, static_cast<uint16_t>(v >> 16));
+  }
+
+  void putF32(std::vector<uint8_t>& out, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    putU32(out, v);
+  }
+
+  void putCodes(std::vector<uint8_t>& out, const int16_t* codes, size_t count) {
+    for (size_t i = 0; i < count; ++i) putU16(out, static_cast<uint16_t>(codes[i]));
+  }
+}
 
 std::vector<Scope::Channel> Scope::_channels;
+float Scope::_timebaseMsPerDiv = 10.0f;
+bool Scope::_average = true;
+uint32_t Scope::_captureTimeoutMs = Scope::CAPTURE_TIMEOUT_MS;
+uint32_t Scope::_burstPeriodMs = 250;
+uint32_t Scope::_lastBurstMs = 0;
+ScopeTrigger Scope::_trigger;
+ScopeTrigger::Mode Scope::_trigMode = ScopeTrigger::MODE_AUTO;
+Scope::TrigState Scope::_trigState = Scope::TRIG_OFF;
+int Scope::_trigChannel = -1;
+uint32_t Scope::_autoMs = 100;
+uint32_t Scope::_armSeq = 0;
+uint32_t Scope::_armMs = 0;
+bool Scope::_preFilled = false;
+uint32_t Scope::_fireMs = 0;
+uint32_t Scope::_trigUs = 0;
+uint32_t Scope::_lastSourceUs = 0;
+bool Scope::_forced = false;
+uint32_t Scope::_captures = 0;
+bool Scope::_captureForced = false;
+uint32_t Scope::_captureUs = 0;
+uint32_t Scope::_frames = 0;
+int Scope::_rollChannel = -1;
+uint32_t Scope::_rollSeq = 0;
+uint16_t Scope::_segmentCount = 0;
+uint16_t Scope::_segmentFill = 0;
+std::vector<uint32_t> Scope::_segmentUs;
+std::vector<uint32_t> Scope::_segmentCaptureUs;
+uint32_t Scope::_segmentEnd = 0;
+uint32_t Scope::_segmentEndUs = 0;
+bool Scope::_holdoff = false;
+uint32_t Scope::_missed = 0;
+uint32_t Scope::_rearmUs = 0;
+uint32_t Scope::_minIntervalUs = UINT32_MAX;
+ScopeSpectrum Scope::_spectrum;
+int Scope::_spectrumChannel = -1;
+uint32_t Scope::_spectrumFrame = 0;
+uint32_t Scope::_spectra = 0;
+uint32_t Scope::_spectrumUs = 0;
 
 void Scope::begin() {
   _channels.clear();
@@ -21,59 +83,996 @@ void Scope::begin() {
     float amp = ch["amplitude"].as<float>();
     float offset = ch["offset"].as<float>();
     size_t size = ch["buffer_size"].as<size_t>();
-    IOBase* io = IORegistry::get(source);
-    if (!io) {
+    IOHandle io = IORegistry::resolve(source);
+    if (io == IO_INVALID) {
       Logger::warn("SCOPE", "begin", String("Unknown IO for scope: ") + source);
       continue;
     }
     Channel c;
     c.name = name;
     c.io = io;
+    c.burst = ch["mode"] == "burst";
+    c.burstTimebase = ch["burst_rate_hz"].isNull();
+    c.burstRateHz = ch["burst_rate_hz"] | 0;
+    c.burstFast = ch["burst_fast"] | false;
+    if (c.burst && !IORegistry::at(io)->supportsBurst()) {
+      Logger::warn("SCOPE", "begin", String("Burst not supported, streaming: ") + source);
+      c.burst = false;
+    }
+    if (!c.burst && !Acquisition::attach(io, c.reader)) {
+      Logger::warn("SCOPE", "begin", String("IO is not sampled: ") + source);
+      continue;
+    }
     c.amplitude = amp;
     c.offset = offset;
-    c.bufferSize = size > 0 ? size : 256;
-    c.buffer.reserve(c.bufferSize);
+    if (size == 0) size = 256;
+    if (size > 4096) size = 4096;
+    c.ring.allocate(size);
+    c.pre = 0;
+    c.captureTrigger = 0;
+    c.pendingTrigger = 0;
+    c.trigSeq = 0;
+    c.located = false;
+    c.frozen = false;
+    c.averaged = false;
+    c.decimation = 1;
+    c.decimCount = 0;
+    c.decimSum = 0;
+    String storage = ch["storage"] | "int16";
+    if (storage != "int16" && storage != "packed") {
+      Logger::warn("SCOPE", "begin", String("Unknown storage ") + storage);
+    }
+    c.packed = storage == "packed" && !c.burst;
+    if (storage == "packed" && c.burst) {
+      Logger::warn("SCOPE", "begin", String("Packed storage needs a streamed channel: ") + name);
+    }
+    c.segLength = 0;
+    c.segPre = 0;
+    c.segLocated = 0;
+    c.segDone = 0;
+    uint8_t harmonics = ch["harmonics"] | 0;
+    c.analyze = harmonics > 0 && !c.burst;
+    if (harmonics > 0 && c.burst) {
+      Logger::warn("SCOPE", "begin", String("Harmonic analysis needs a streamed channel: ") + name);
+    }
+    if (c.analyze) c.harmonics.configure(harmonics, ch["harmonic_cycles"] | 10);
     _channels.push_back(c);
   }
+
+  _trigChannel = -1;
+  _trigState = TRIG_OFF;
+  _captures = 0;
+  _segmentCount = 0;
+  _segmentCaptureUs.clear();
+  _missed = 0;
+  _rearmUs = 0;
+  _minIntervalUs = UINT32_MAX;
+  applyTimebase();
+  applySpectrum();
+  applyAverage();
+  _rollChannel = -1;
+  _rollSeq = 0;
+  for (size_t k = 0; k < _channels.size() && _rollChannel < 0; ++k) {
+    if (!_channels[k].burst) _rollChannel = static_cast<int>(k);
+  }
+  JsonObject trig = doc["trigger"].as<JsonObject>();
+  String source = trig["source"] | "";
+  if (trig.isNull() || source.length() == 0) return;
+  for (size_t k = 0; k < _channels.size(); ++k) {
+    if (_channels[k].name == source && !_channels[k].burst) _trigChannel = static_cast<int>(k);
+  }
+  if (_trigChannel < 0) {
+    Logger::warn("SCOPE", "trigger", String("Source must be a streamed channel: ") + source);
+    return;
+  }
+  ScopeTrigger::Type type;
+  String typeName = trig["type"] | "rising";
+  if (!ScopeTrigger::parseType(typeName, type)) {
+    Logger::warn("SCOPE", "trigger", String("Unknown type ") + typeName);
+    type = ScopeTrigger::EDGE_RISING;
+  }
+  String modeName = trig["mode"] | "auto";
+  if (!ScopeTrigger::parseMode(modeName, _trigMode)) {
+    Logger::warn("SCOPE", "trigger", String("Unknown mode ") + modeName);
+    _trigMode = ScopeTrigger::MODE_AUTO;
+  }
+  // Seuils convertis une fois en codes de l'IO source
+  float volts = IORegistry::at(_channels[_trigChannel].io)->scale();
+  _trigger.configure(type, lroundf((trig["level"] | 0.0f) / volts),
+                     lroundf((trig["hysteresis"] | 0.0f) / volts));
+  _autoMs = trig["auto_ms"] | 100;
+  float prePercent = trig["pre_percent"] | 50.0f;
+  if (prePercent < 0.0f) prePercent = 0.0f;
+  if (prePercent > 100.0f) prePercent = 100.0f;
+  uint16_t segments = trig["segments"] | 0;
+  _segmentCount = segments > MAX_SEGMENTS ? MAX_SEGMENTS : (segments < 2 ? 0 : segments);
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    size_t capacity = ch.ring.capacity();
+    size_t pre = static_cast<size_t>(capacity * prePercent / 100.0f);
+    ch.pre = static_cast<uint16_t>(pre < capacity ? pre : capacity - 1);
+    if (!ch.packed) {
+      ch.pending.reserve(capacity);
+      ch.capture.reserve(capacity);
+    }
+    if (_segmentCount && capacity / _segmentCount < 2) {
+      Logger::warn("SCOPE", "trigger", String("Buffer too small for segments: ") + ch.name);
+      _segmentCount = static_cast<uint16_t>(capacity / 2);
+    }
+  }
+  if (_segmentCount) {
+    // La mémoire de capture de chaque canal est partagée entre les segments
+    for (auto &ch : _channels) {
+      if (ch.burst) continue;
+      ch.segLength = static_cast<uint16_t>(ch.ring.capacity() / _segmentCount);
+      size_t pre = static_cast<size_t>(ch.segLength * prePercent / 100.0f);
+      ch.segPre = static_cast<uint16_t>(pre < ch.segLength ? pre : ch.segLength - 1);
+      ch.segTrig.assign(_segmentCount, 0);
+    }
+    _segmentUs.assign(_segmentCount, 0);
+    Logger::info("SCOPE", "trigger", String(_segmentCount) + " segments of " +
+                 _channels[_trigChannel].segLength + " samples");
+  }
+  rearm();
+}
+
+void Scope::applyTimebase() {
+  auto& doc = ConfigStore::doc("scope");
+  _timebaseMsPerDiv = doc["timebase_ms_per_div"] | 10.0f;
+  if (!(_timebaseMsPerDiv > 0.0f)) _timebaseMsPerDiv = 10.0f;
+  String acquisition = doc["acquisition"] | "average";
+  if (acquisition != "average" && acquisition != "sample") {
+    Logger::warn("SCOPE", "timebase", String("Unknown acquisition ") + acquisition);
+  }
+  _average = acquisition != "sample";
+  _burstPeriodMs = doc["burst_period_ms"] | 250;
+  float windowUs = _timebaseMsPerDiv * 1000.0f * DIVISIONS;
+  for (auto &ch : _channels) {
+    float wantedUs = windowUs / ch.ring.capacity();
+    if (ch.burst) {
+      if (ch.burstTimebase) ch.burstRateHz = static_cast<uint32_t>(lroundf(1000000.0f / wantedUs));
+      continue;
+    }
+    // Facteur entier le plus proche ; 1 si la cadence native est déjà trop lente
+    uint32_t rate = Acquisition::rateHz(ch.io);
+    float factor = rate ? wantedUs * rate / 1000000.0f : 1.0f;
+    long decimation = factor > 1.0f ? lroundf(factor) : 1;
+    ch.decimation = static_cast<uint16_t>(decimation > 65535 ? 65535 : decimation);
+    ch.decimCount = 0;
+    ch.decimSum = 0;
+    // Anneaux et captures ne mélangent pas deux intervalles
+    ch.ring.reset();
+    ch.capture.clear();
+    ch.packedCapture.clear();
+    ch.pyramid.build(nullptr, 0);
+    ch.averaged = false;
+  }
+  for (auto &ch : _channels) {
+    ch.measure.reset(ch.ring.capacity());
+    if (ch.analyze) ch.harmonics.reset();
+    ch.averager.reset();
+  }
+  // Une capture lente n'est pas close avant l'arrivée de ses échantillons
+  _captureTimeoutMs = CAPTURE_TIMEOUT_MS;
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    uint32_t windowMs = static_cast<uint32_t>(ch.ring.capacity() * intervalUs(ch) / 1000.0f);
+    if (CAPTURE_TIMEOUT_MS + windowMs > _captureTimeoutMs) _captureTimeoutMs = CAPTURE_TIMEOUT_MS + windowMs;
+  }
+  _rollSeq = 0;
+  if (_trigChannel >= 0) rearm();
+  Logger::info("SCOPE", "timebase", String(_timebaseMsPerDiv, 3) + " ms/div, " + acquisition);
+}
+
+void Scope::applySpectrum() {
+  JsonObject cfg = ConfigStore::doc("scope")["spectrum"].as<JsonObject>();
+  _spectrumChannel = -1;
+  _spectrumFrame = _frames;
+  if (!(cfg["enabled"] | false) || _channels.empty()) {
+    _spectrum.release();
+    return;
+  }
+  String name = cfg["channel"] | "";
+  _spectrumChannel = 0;
+  for (size_t k = 0; k < _channels.size(); ++k) {
+    if (_channels[k].name == name) _spectrumChannel = static_cast<int>(k);
+  }
+  if (name.length() && _channels[_spectrumChannel].name != name) {
+    Logger::warn("SCOPE", "spectrum", String("Unknown channel ") + name);
+  }
+  uint32_t size = cfg["size"] | 1024;
+  if (!FixedFft::validSize(size)) {
+    Logger::warn("SCOPE", "spectrum", String("Size must be a power of two in 256..2048: ") + size);
+    size = 1024;
+  }
+  // La transformée porte sur les derniers codes d'une capture
+  uint32_t length = _channels[_spectrumChannel].ring.capacity();
+  if (length < FixedFft::MIN_SIZE) {
+    Logger::warn("SCOPE", "spectrum", _channels[_spectrumChannel].name + " capture is shorter than " +
+                 FixedFft::MIN_SIZE + " samples");
+    _spectrumChannel = -1;
+    _spectrum.release();
+    return;
+  }
+  if (size > length) {
+    Logger::warn("SCOPE", "spectrum", String("Size ") + size + " exceeds the " + length +
+                 "-sample capture, reduced");
+    size = length;
+  }
+  FixedFft::Window window;
+  String windowName = cfg["window"] | "hann";
+  if (!FixedFft::parseWindow(windowName, window)) {
+    Logger::warn("SCOPE", "spectrum", String("Unknown window ") + windowName);
+    window = FixedFft::WINDOW_HANN;
+  }
+  _spectrum.configure(static_cast<uint16_t>(size), window, cfg["peaks"] | 5);
+  Logger::info("SCOPE", "spectrum", _channels[_spectrumChannel].name + ", " + size + " points, " +
+               FixedFft::windowName(window));
+}
+
+void Scope::applyAverage() {
+  JsonObject cfg = ConfigStore::doc("scope")["average"].as<JsonObject>();
+  ScopeAverager::Mode mode = ScopeAverager::MODE_OFF;
+  String modeName = cfg["mode"] | "off";
+  if (!ScopeAverager::parseMode(modeName, mode)) {
+    Logger::warn("SCOPE", "average", String("Unknown mode ") + modeName);
+  }
+  uint16_t count = cfg["count"] | 16;
+  bool peak = cfg["peak_detect"] | false;
+  uint16_t persistence = cfg["persistence"] | 0;
+  size_t streams = 0;
+  for (auto &ch : _channels) {
+    if (!ch.burst) streams++;
+  }
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    // Part égale du budget ; la moyenne glissante y ajuste son historique
+    size_t share = AVERAGE_HEAP_BUDGET / streams;
+    uint32_t length = ch.ring.capacity();
+    uint16_t fitted = count;
+    while (fitted > 1 && ScopeAverager::bytes(mode, fitted, peak, length) > share) fitted--;
+    ScopeAverager::Mode channelMode = mode;
+    bool channelPeak = peak;
+    if (ScopeAverager::bytes(mode, fitted, peak, length) > share) {
+      Logger::warn("SCOPE", "average", String("Buffer too large for averaging: ") + ch.name);
+      channelMode = ScopeAverager::MODE_OFF;
+      channelPeak = false;
+    } else if (fitted < count && mode == ScopeAverager::MODE_RUNNING) {
+      Logger::warn("SCOPE", "average", ch.name + " averages " + fitted + " captures");
+    }
+    ch.averager.configure(channelMode, fitted, channelPeak, persistence);
+  }
+  if (mode != ScopeAverager::MODE_OFF || peak) {
+    Logger::info("SCOPE", "average", String(ScopeAverager::modeName(mode)) + ", " + count +
+                 " captures" + (peak ? ", peak detect" : ""));
+  }
+}
+
+void Scope::arm() {
+  if (_trigChannel < 0) return;
+  // Nouvelle série : les moyennes repartent de la prochaine capture
+  for (auto &ch : _channels) ch.averager.reset();
+  rearm();
+}
+
+void Scope::rearm() {
+  Channel& src = _channels[_trigChannel];
+  _trigState = TRIG_ARMING;
+  _armSeq = src.ring.seq();
+  _armMs = millis();
+  _preFilled = false;
+  _forced = false;
+  _trigger.rearm();
+  for (auto &ch : _channels) {
+    ch.located = false;
+    ch.frozen = false;
+  }
+  if (_segmentCount) {
+    // Premier segment : attendre sa pré-capture
+    _segmentEnd = src.ring.seq() + src.segPre;
+    _holdoff = false;
+    startSequence();
+  }
+}
+
+void Scope::startSequence() {
+  _segmentFill = 0;
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    ch.segLocated = 0;
+    ch.segDone = 0;
+    // Segments d'un canal en retard laissés à zéro
+    ch.pending.assign(static_cast<size_t>(ch.segLength) * _segmentCount, 0);
+  }
+}
+
+void Scope::segmentTrigger(Channel& src, int16_t code, uint32_t tUs) {
+  bool fired = _trigger.test(code);
+  // Un déclenchement de niveau reste vrai tant que le signal est du bon
+  // côté : seuls les fronts comptent comme manqués
+  bool edge = _trigger.type() == ScopeTrigger::EDGE_RISING ||
+              _trigger.type() == ScopeTrigger::EDGE_FALLING;
+  if (_trigState != TRIG_ARMING) {
+    // Séquence pleine, en attente de copie
+    if (fired && edge && _trigState == TRIG_CAPTURING) _missed++;
+    return;
+  }
+  uint32_t seq = src.ring.seq();
+  if (_holdoff) {
+    if (static_cast<int32_t>(seq - _segmentEnd) <= 0) {
+      if (seq == _segmentEnd) _segmentEndUs = tUs;
+      if (fired && edge) _missed++;
+      return;
+    }
+    // Premier échantillon testé après la fin du segment précédent
+    _rearmUs = tUs - _segmentEndUs;
+    _holdoff = false;
+  } else if (static_cast<int32_t>(seq - _segmentEnd) <= 0) {
+    return;
+  }
+  if (!fired) return;
+  uint16_t k = _segmentFill++;
+  _segmentUs[k] = tUs;
+  if (k > 0 && tUs - _segmentUs[k - 1] < _minIntervalUs) _minIntervalUs = tUs - _segmentUs[k - 1];
+  _segmentEnd = seq - 1 + src.segLength - src.segPre;
+  _holdoff = true;
+  if (_segmentFill == _segmentCount) {
+    _trigState = TRIG_CAPTURING;
+    _fireMs = millis();
+  }
+}
+
+void Scope::segmentCopy(Channel& ch, uint32_t tUs) {
+  while (ch.segLocated < _segmentFill &&
+         static_cast<int32_t>(tUs - _segmentUs[ch.segLocated]) >= 0) {
+    ch.segTrig[ch.segLocated++] = ch.ring.seq() - 1;
+  }
+  uint32_t post = ch.segLength - ch.segPre;
+  while (ch.segDone < ch.segLocated && ch.ring.seq() - ch.segTrig[ch.segDone] >= post) {
+    CaptureRing<int16_t>::View view = ch.ring.range(ch.segTrig[ch.segDone] - ch.segPre, ch.segLength);
+    int16_t* out = ch.pending.data() + static_cast<size_t>(ch.segDone) * ch.segLength;
+    memcpy(out, view.first(), view.firstLength() * sizeof(int16_t));
+    memcpy(out + view.firstLength(), view.second(), view.secondLength() * sizeof(int16_t));
+    ch.segDone++;
+  }
+  if (_trigState != TRIG_CAPTURING || ch.segDone < _segmentCount) return;
+  for (auto &other : _channels) {
+    if (!other.burst && other.segDone < _segmentCount) return;
+  }
+  completeSequence();
+}
+
+void Scope::completeSequence() {
+  // Séquence close par le délai : ses segments manquants sont à zéro
+  bool full = _segmentFill == _segmentCount;
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    ch.capture.swap(ch.pending);
+    ch.captureTrigger = ch.segPre;
+    ch.averaged = full && !ch.capture.empty();
+    if (ch.averaged) ch.averager.add(ch.capture.data(), ch.capture.size());
+    storeCapture(ch);
+  }
+  _segmentCaptureUs.assign(_segmentUs.begin(), _segmentUs.begin() + _segmentFill);
+  _captures++;
+  _frames++;
+  _captureForced = false;
+  _captureUs = _segmentUs[0];
+  if (_trigMode == ScopeTrigger::MODE_SINGLE) {
+    _trigState = TRIG_STOPPED;
+  } else {
+    // Séquence suivante sans pré-capture à attendre ; l'attente de la
+    // copie n'est pas un temps de réarmement entre segments
+    _trigState = TRIG_ARMING;
+    _holdoff = false;
+    startSequence();
+  }
+}
+
+void Scope::fire(uint32_t tUs, bool forced) {
+  Channel& src = _channels[_trigChannel];
+  _trigState = TRIG_CAPTURING;
+  _trigUs = tUs;
+  _forced = forced;
+  _fireMs = millis();
+  src.trigSeq = src.ring.seq() - 1;
+  src.located = true;
+  // Pré-capture de 100 % : rien à attendre après le déclenchement
+  if (src.ring.seq() - src.trigSeq >= src.ring.capacity() - src.pre) freeze(src);
+}
+
+void Scope::freeze(Channel& ch) {
+  // Copie des deux segments de l'anneau, du plus ancien au plus récent
+  CaptureRing<int16_t>::View view = ch.ring.view();
+  ch.pending.assign(view.first(), view.first() + view.firstLength());
+  ch.pending.insert(ch.pending.end(), view.second(), view.second() + view.secondLength());
+  ch.pendingTrigger = static_cast<uint16_t>(ch.trigSeq - view.start);
+  ch.frozen = true;
+  for (auto &other : _channels) {
+    if (!other.burst && !other.frozen) return;
+  }
+  complete();
+}
+
+void Scope::complete() {
+  // Tous les canaux basculent ensemble sur la nouvelle capture
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    if (!ch.frozen) {
+      // Canal en retard (IO hors ligne) : capture vide
+      ch.pending.clear();
+      ch.pendingTrigger = 0;
+    }
+    ch.capture.swap(ch.pending);
+    ch.captureTrigger = ch.pendingTrigger;
+    // Ni capture forcée ni capture vide : une longueur différente
+    // remettrait les accumulateurs à zéro
+    ch.averaged = !_forced && !ch.capture.empty();
+    if (ch.averaged) ch.averager.add(ch.capture.data(), ch.capture.size());
+    storeCapture(ch);
+  }
+  _captures++;
+  _frames++;
+  _captureForced = _forced;
+  _captureUs = _trigUs;
+  if (_trigMode == ScopeTrigger::MODE_SINGLE) {
+    _trigState = TRIG_STOPPED;
+  } else {
+    rearm();
+  }
+}
+
+void Scope::storeCapture(Channel& ch) {
+  ch.pyramid.build(ch.capture.data(), ch.capture.size());
+  if (!ch.packed) return;
+  // Seule la forme compactée reste sur le tas jusqu'à la capture suivante
+  ch.packedCapture.pack(ch.capture.data(), ch.capture.size());
+  std::vector<int16_t>().swap(ch.capture);
+  std::vector<int16_t>().swap(ch.pending);
 }
 
 void Scope::loop() {
-  // Échantillonne chaque canal et stocke la valeur dans un tampon
-  // circulaire.  Les valeurs sont converties en tension physique
-  // via getVref() et getRatio(), puis mises à l'échelle selon
-  // l'amplitude et l'offset configurés pour ce canal.  Le tampon
-  // conserve un nombre fixe d'échantillons défini par bufferSize.
-  for (auto &ch : _channels) {
-    float raw = ch.io->readRaw();
-    float value = raw * ch.io->getVref() * ch.io->getRatio();
-    // Mise à l'échelle : valeur relative à l'offset puis divisée par
-    // l'amplitude.  Si amplitude vaut 0, on évite la division.
-    float scaled;
-    if (ch.amplitude > 0.0f) {
-      scaled = (value - ch.offset) / ch.amplitude;
+  // Consomme les échantillons du moteur d'acquisition et stocke leurs
+  // codes bruts dans le tampon circulaire du canal.
+  // La conversion en tension et la mise à l'échelle sont reportées à
+  // toJson(), qui ne traite que les échantillons effectivement envoyés.
+  // Les canaux en mode rafale sont recapturés d'un bloc toutes les
+  // _burstPeriodMs ; la rafale bloque la boucle le temps de la capture.
+  // Le canal source du déclenchement est lu en premier : l'instant de
+  // déclenchement est connu avant que les autres canaux s'y alignent.
+  uint32_t nowMs = millis();
+  if (_trigState == TRIG_ARMING && _trigMode == ScopeTrigger::MODE_AUTO && _preFilled &&
+      _segmentCount == 0 && nowMs - _armMs >= _autoMs) {
+    fire(_lastSourceUs, true);
+  }
+  if (_trigState == TRIG_CAPTURING && nowMs - _fireMs >= _captureTimeoutMs) {
+    if (_segmentCount) {
+      completeSequence();
     } else {
-      scaled = value - ch.offset;
+      complete();
     }
-    // Ajoute au tampon
-    if (ch.buffer.size() < ch.bufferSize) {
-      ch.buffer.push_back(scaled);
-    } else {
-      // déplacement circulaire : on supprime le plus ancien
-      ch.buffer.erase(ch.buffer.begin());
-      ch.buffer.push_back(scaled);
+  }
+  if (_trigChannel >= 0) stream(_channels[_trigChannel], true);
+  bool burstDue = nowMs - _lastBurstMs >= _burstPeriodMs;
+  for (size_t k = 0; k < _channels.size(); ++k) {
+    Channel &ch = _channels[k];
+    if (ch.burst) {
+      if (!burstDue) continue;
+      IOBase* io = IORegistry::at(ch.io);
+      if (!io) continue;
+      // La rafale remplit le tampon d'un bloc, du plus ancien au plus récent
+      int16_t* block = ch.ring.block();
+      uint16_t count = static_cast<uint16_t>(ch.ring.capacity());
+      if (!io->captureBurst(block, count, ch.burstRateHz, ch.burstFast, ch.info)) {
+        count = 0;
+      }
+      if (io->calibrated()) {
+        // La rafale contourne le moteur d'acquisition : étalonnage ici
+        for (uint16_t i = 0; i < count; ++i) block[i] = io->calibrate(block[i]);
+      }
+      ch.ring.commitBlock(count);
+      ch.pyramid.build(block, count);
+      for (uint16_t i = 0; i < count; ++i) ch.measure.push(block[i]);
+      _frames++;
+      _lastBurstMs = nowMs;
+      continue;
+    }
+    if (static_cast<int>(k) != _trigChannel) stream(ch, false);
+  }
+  if (_trigChannel < 0 && _rollChannel >= 0) {
+    // Sans déclenchement, une trame par renouvellement complet de l'anneau
+    const CaptureRing<int16_t>& ring = _channels[_rollChannel].ring;
+    if (ring.seq() - _rollSeq >= ring.capacity()) {
+      _rollSeq = ring.seq();
+      _frames++;
+      for (auto &ch : _channels) {
+        if (ch.burst) continue;
+        CaptureRing<int16_t>::View view = ch.ring.view();
+        ch.capture.assign(view.first(), view.first() + view.firstLength());
+        ch.capture.insert(ch.capture.end(), view.second(), view.second() + view.secondLength());
+        storeCapture(ch);
+      }
+    }
+  }
+  if (_spectrumChannel >= 0 && _spectrumFrame != _frames) {
+    // Un spectre par capture complète du canal analysé
+    _spectrumFrame = _frames;
+    const Channel& ch = _channels[_spectrumChannel];
+    IOBase* io = IORegistry::at(ch.io);
+    uint32_t count;
+    std::vector<int16_t> scratch;
+    const int16_t* data = captureData(ch, count, scratch);
+    uint32_t t0 = micros();
+    if (io && _spectrum.compute(data, count, io->codeMin(), io->codeMax(), intervalUs(ch))) {
+      _spectrumUs = micros() - t0;
+      _spectra++;
+    }
+  }
+}
+
+void Scope::stream(Channel& ch, bool source) {
+  static const size_t BATCH = 16;
+  Sample samples[BATCH];
+  size_t n;
+  while ((n = Acquisition::read(ch.reader, samples, BATCH)) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      const Sample& s = samples[i];
+      int16_t code = s.code;
+      if (ch.decimation > 1) {
+        // Un échantillon stocké par groupe de `decimation`, daté du dernier
+        ch.decimSum += code;
+        if (++ch.decimCount < ch.decimation) continue;
+        if (_average) {
+          int32_t half = ch.decimation / 2;
+          code = static_cast<int16_t>((ch.decimSum + (ch.decimSum < 0 ? -half : half)) / ch.decimation);
+        }
+        ch.decimSum = 0;
+        ch.decimCount = 0;
+      }
+      ch.ring.push(code);
+      ch.measure.push(code);
+      if (ch.analyze) ch.harmonics.push(code);
+      if (_trigState == TRIG_OFF) continue;
+      if (_segmentCount) {
+        if (source) {
+          _lastSourceUs = s.tUs;
+          segmentTrigger(ch, code, s.tUs);
+        }
+        segmentCopy(ch, s.tUs);
+        continue;
+      }
+      if (source) {
+        _lastSourceUs = s.tUs;
+        // Seuil testé une fois la pré-capture remplie ; le délai du
+        // mode auto court à partir de ce moment
+        if (_trigState == TRIG_ARMING && ch.ring.seq() - _armSeq > ch.pre) {
+          if (!_preFilled) {
+            _preFilled = true;
+            _armMs = millis();
+          }
+          if (_trigger.test(code)) fire(s.tUs, false);
+        }
+      }
+      if (_trigState != TRIG_CAPTURING || ch.frozen) continue;
+      if (!ch.located) {
+        // Premier échantillon du canal à l'instant du déclenchement ou après
+        if (static_cast<int32_t>(s.tUs - _trigUs) < 0) continue;
+        ch.trigSeq = ch.ring.seq() - 1;
+        ch.located = true;
+      }
+      if (ch.ring.seq() - ch.trigSeq >= ch.ring.capacity() - ch.pre) freeze(ch);
+    }
+  }
+}
+
+void Scope::encodeFrame(std::vector<uint8_t>& out) {
+  bool triggered = _trigChannel >= 0;
+  out.clear();
+  size_t size = 16;
+  for (auto &ch : _channels) {
+    size += 17 + 4 * MEASUREMENTS + ch.name.length() + 2 * ch.ring.capacity();
+  }
+  out.reserve(size + 1);
+  static const uint8_t magic[4] = {'M', 'L', 'S', 'F'};
+  out.insert(out.end(), magic, magic + 4);
+  out.push_back(FRAME_VERSION);
+  out.push_back(static_cast<uint8_t>(_channels.size()));
+  // Nombre de captures moyennées de la source, 0 sans moyenne
+  uint16_t averaged = 0;
+  if (triggered && _channels[_trigChannel].averaged &&
+      _channels[_trigChannel].averager.mode() != ScopeAverager::MODE_OFF) {
+    averaged = _channels[_trigChannel].averager.count();
+  }
+  out.push_back((triggered ? 0x01 : 0x00) | (_captureForced ? 0x02 : 0x00) |
+                (averaged ? 0x04 : 0x00));
+  out.push_back(static_cast<uint8_t>(averaged > 255 ? 255 : averaged));
+  putU32(out, _frames);
+  putU32(out, _captureUs);
+
+  // Métadonnées puis codes.  Un canal en flux envoie sa dernière
+  // capture, celle de la pyramide et du spectre, et non son anneau ;
+  // les vues des rafales sont prises une fois
+  std::vector<CaptureRing<int16_t>::View> views(_channels.size());
+  for (size_t k = 0; k < _channels.size(); ++k) {
+    Channel &ch = _channels[k];
+    float gain;
+    float shift;
+    scaling(ch, gain, shift);
+    if (ch.burst) views[k] = ch.ring.view();
+    putU16(out, static_cast<uint16_t>(ch.burst ? views[k].size() : captureCount(ch)));
+    putU16(out, triggered && !ch.burst ? ch.captureTrigger : 0xFFFF);
+    putF32(out, gain);
+    putF32(out, shift);
+    putF32(out, intervalUs(ch));
+    float values[MEASUREMENTS];
+    measurements(ch, values);
+    for (float v : values) putF32(out, v);
+    uint8_t len = static_cast<uint8_t>(ch.name.length() > 255 ? 255 : ch.name.length());
+    out.push_back(len);
+    out.insert(out.end(), ch.name.c_str(), ch.name.c_str() + len);
+  }
+  if (out.size() & 1) out.push_back(0);
+  for (size_t k = 0; k < _channels.size(); ++k) {
+    Channel &ch = _channels[k];
+    if (!ch.burst) {
+      if (ch.packed) {
+        // Décodage au fil de la sérialisation
+        PackedCodes::Reader reader(ch.packedCapture);
+        for (size_t i = 0; i < ch.packedCapture.count(); ++i) putU16(out, static_cast<uint16_t>(reader.next()));
+      } else {
+        putCodes(out, ch.capture.data(), ch.capture.size());
+      }
+      continue;
+    }
+    const CaptureRing<int16_t>::View& v = views[k];
+    putCodes(out, v.first(), v.firstLength());
+    putCodes(out, v.second(), v.secondLength());
+  }
+}
+
+void Scope::encodeSpectrum(std::vector<uint8_t>& out) {
+  out.clear();
+  if (_spectrumChannel < 0) return;
+  const String& name = _channels[_spectrumChannel].name;
+  uint8_t len = static_cast<uint8_t>(name.length() > 255 ? 255 : name.length());
+  const std::vector<ScopeSpectrum::Peak>& peaks = _spectrum.peaks();
+  uint16_t bins = _spectrum.points() / 2;
+  out.reserve(21 + 8 * peaks.size() + len + 2 * bins);
+  static const uint8_t magic[4] = {'M', 'L', 'S', 'P'};
+  out.insert(out.end(), magic, magic + 4);
+  out.push_back(SPECTRUM_VERSION);
+  out.push_back(_spectrum.window());
+  out.push_back(static_cast<uint8_t>(peaks.size()));
+  out.push_back(len);
+  putU32(out, _spectra);
+  putU16(out, _spectrum.points());
+  putU16(out, 0);
+  putF32(out, _spectrum.binHz());
+  for (const auto& peak : peaks) {
+    putF32(out, peak.hz);
+    putF32(out, peak.dbfs);
+  }
+  out.insert(out.end(), name.c_str(), name.c_str() + len);
+  if (out.size() & 1) out.push_back(0);
+  putCodes(out, _spectrum.bins(), bins);
+}
+
+bool Scope::spectrumToJson(JsonObject& out) {
+  if (_spectrumChannel < 0) return false;
+  out["channel"] = _channels[_spectrumChannel].name;
+  out["window"] = FixedFft::windowName(_spectrum.window());
+  out["size"] = _spectrum.size();
+  out["points"] = _spectrum.points();
+  out["bin_hz"] = _spectrum.binHz();
+  out["seq"] = _spectra;
+  out["compute_us"] = _spectrumUs;
+  JsonArray peaks = out["peaks"].to<JsonArray>();
+  for (const auto& peak : _spectrum.peaks()) {
+    JsonObject p = peaks.add<JsonObject>();
+    p["hz"] = peak.hz;
+    p["dbfs"] = peak.dbfs;
+  }
+  // Raies 0..points/2 − 1, en dBFS
+  JsonArray dbfs = out["dbfs"].to<JsonArray>();
+  for (uint16_t k = 0; k < _spectrum.points() / 2; ++k) dbfs.add(_spectrum.bins()[k] / 100.0f);
+  return true;
+}
+
+void Scope::encodeSegments(std::vector<uint8_t>& out) {
+  out.clear();
+  if (!_segmentCount || _segmentCaptureUs.empty()) return;
+  uint16_t segments = static_cast<uint16_t>(_segmentCaptureUs.size());
+  uint8_t streams = 0;
+  size_t size = 16 + 8 * segments;
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    streams++;
+    size += 17 + ch.name.length() + 2 * captureCount(ch);
+  }
+  out.reserve(size + 1);
+  static const uint8_t magic[4] = {'M', 'L', 'S', 'G'};
+  out.insert(out.end(), magic, magic + 4);
+  out.push_back(SEGMENTS_VERSION);
+  out.push_back(streams);
+  putU16(out, segments);
+  putU32(out, _captures);
+  putU32(out, _segmentCaptureUs[0]);
+  for (auto &ch : _channels) {
+    if (ch.burst) continue;
+    float gain;
+    float shift;
+    scaling(ch, gain, shift);
+    putU16(out, ch.segLength);
+    putU16(out, ch.segPre);
+    putF32(out, gain);
+    putF32(out, shift);
+    putF32(out, intervalUs(ch));
+    uint8_t len = static_cast<uint8_t>(ch.name.length() > 255 ? 255 : ch.name.length());
+    out.push_back(len);
+    out.insert(out.end(), ch.name.c_str(), ch.name.c_str() + len);
+  }
+  if (out.size() & 1) out.push_back(0);
+  // Captures compactées lues dans l'ordre, un lecteur par canal
+  std::vector<PackedCodes::Reader> readers;
+  for (auto &ch : _channels) {
+    if (!ch.burst && ch.packed) readers.emplace_back(ch.packedCapture);
+  }
+  for (uint16_t k = 0; k < segments; ++k) {
+    putU32(out, _segmentCaptureUs[k]);
+    putU32(out, k ? _segmentCaptureUs[k] - _segmentCaptureUs[k - 1] : 0);
+    size_t r = 0;
+    for (auto &ch : _channels) {
+      if (ch.burst) continue;
+      // Capture plus courte (séquence interrompue par begin()) : zéros
+      size_t first = static_cast<size_t>(k) * ch.segLength;
+      size_t available = captureCount(ch);
+      for (uint16_t i = 0; i < ch.segLength; ++i) {
+        int16_t code = 0;
+        if (first + i < available) code = ch.packed ? readers[r].next() : ch.capture[first + i];
+        putU16(out, static_cast<uint16_t>(code));
+      }
+      if (ch.packed) r++;
     }
   }
 }
 
+void Scope::scaling(const Channel& ch, float& gain, float& shift) {
+  // Mise à l'échelle : tension relative à l'offset puis divisée par
+  // l'amplitude.  Si amplitude vaut 0, on évite la division.  Les
+  // deux opérations sont regroupées en un gain et un décalage.
+  IOBase* io = IORegistry::at(ch.io);
+  gain = io ? io->scale() : 0.0f;
+  shift = -ch.offset;
+  if (ch.amplitude > 0.0f) {
+    gain /= ch.amplitude;
+    shift /= ch.amplitude;
+  }
+}
+
+const char* const* Scope::measurementNames() {
+  static const char* const names[MEASUREMENTS] = {
+    "vmin", "vmax", "vpp", "mean", "rms",
+    "frequency_hz", "period_us", "duty_percent", "rise_us", "fall_us"};
+  return names;
+}
+
+void Scope::measurements(const Channel& ch, float* out) {
+  const ScopeMeasure::Result& r = ch.measure.result();
+  for (uint8_t m = 0; m < MEASUREMENTS; ++m) out[m] = NAN;
+  if (!r.valid) return;
+  float gain;
+  float shift;
+  scaling(ch, gain, shift);
+  float lo = r.min * gain + shift;
+  float hi = r.max * gain + shift;
+  if (lo > hi) {
+    float t = lo;
+    lo = hi;
+    hi = t;
+  }
+  out[0] = lo;
+  out[1] = hi;
+  out[2] = hi - lo;
+  out[3] = r.mean * gain + shift;
+  // Moyenne de (code × gain + shift)² développée sur les accumulateurs
+  float square = gain * gain * r.meanSquare + 2.0f * gain * shift * r.mean + shift * shift;
+  out[4] = sqrtf(square > 0.0f ? square : 0.0f);
+  float interval = intervalUs(ch);
+  if (r.period > 0.0f && interval > 0.0f) {
+    out[6] = r.period * interval;
+    out[5] = 1000000.0f / out[6];
+  }
+  if (r.duty >= 0.0f) out[7] = r.duty * 100.0f;
+  if (r.rise > 0.0f) out[8] = r.rise * interval;
+  if (r.fall > 0.0f) out[9] = r.fall * interval;
+}
+
+uint32_t Scope::captureCount(const Channel& ch) {
+  return ch.packed ? ch.packedCapture.count() : ch.capture.size();
+}
+
+const int16_t* Scope::captureData(const Channel& ch, uint32_t& count,
+                                  std::vector<int16_t>& scratch) {
+  if (ch.packed) {
+    count = ch.packedCapture.count();
+    scratch.resize(count);
+    ch.packedCapture.unpack(scratch.data());
+    return scratch.data();
+  }
+  if (!ch.burst) {
+    count = ch.capture.size();
+    return ch.capture.data();
+  }
+  // Rafale : bloc écrit depuis le début du stockage
+  CaptureRing<int16_t>::View view = ch.ring.view();
+  count = view.size();
+  return view.first();
+}
+
+float Scope::intervalUs(const Channel& ch) {
+  if (ch.burst) return ch.info.intervalUs;
+  uint32_t rate = Acquisition::rateHz(ch.io);
+  return rate ? 1000000.0f * ch.decimation / rate : 0.0f;
+}
+
+bool Scope::envelope(const String& name, uint32_t start, uint32_t count, uint16_t width,
+                     JsonObject& out, String& error) {
+  const Channel* found = nullptr;
+  for (auto &ch : _channels) {
+    if (ch.name == name) found = &ch;
+  }
+  if (!found) {
+    error = String("unknown channel ") + name;
+    return false;
+  }
+  const Channel& ch = *found;
+  if (width == 0 || width > MAX_ENVELOPE_WIDTH) {
+    error = String("width must be 1..") + MAX_ENVELOPE_WIDTH;
+    return false;
+  }
+  uint32_t available;
+  std::vector<int16_t> scratch;
+  const int16_t* data = captureData(ch, available, scratch);
+  if (start > available) {
+    error = "start beyond capture";
+    return false;
+  }
+  if (count == 0 || count > available - start) count = available - start;
+  float gain;
+  float shift;
+  scaling(ch, gain, shift);
+  uint16_t columns = count < width ? static_cast<uint16_t>(count) : width;
+  std::vector<int16_t> mins(columns);
+  std::vector<int16_t> maxs(columns);
+  uint8_t level = ch.pyramid.envelope(data, start, count, columns, mins.data(), maxs.data());
+  out["channel"] = ch.name;
+  out["start"] = start;
+  out["count"] = count;
+  out["width"] = columns;
+  out["level"] = level;
+  out["interval_us"] = intervalUs(ch);
+  if (_trigChannel >= 0 && !ch.burst) {
+    // Position du déclenchement relative à start (hors fenêtre possible)
+    out["trigger"] = static_cast<int32_t>(ch.captureTrigger) - static_cast<int32_t>(start);
+  }
+  JsonArray lo = out["min"].to<JsonArray>();
+  JsonArray hi = out["max"].to<JsonArray>();
+  for (uint16_t i = 0; i < columns; ++i) {
+    lo.add(mins[i] * gain + shift);
+    hi.add(maxs[i] * gain + shift);
+  }
+  return true;
+}
+
 void Scope::toJson(JsonObject& out) {
   // Retourne l'état de chaque canal sous forme de tableau JSON.  On
   // transmet les valeurs brutes mises à l'échelle (scaled).  Cette
   // méthode peut être appelée depuis l'API REST pour récupérer un
   // ensemble d'échantillons pour l'affichage côté client.
+  bool triggered = _trigChannel >= 0;
   for (auto &ch : _channels) {
     JsonArray buf = out[ch.name].to<JsonArray>();
-    for (float v : ch.buffer) {
-      buf.add(v);
+    if (!IORegistry::at(ch.io)) continue;
+    float gain;
+    float shift;
+    scaling(ch, gain, shift);
+    float values[MEASUREMENTS];
+    measurements(ch, values);
+    JsonObject measures = out["measurements"][ch.name].to<JsonObject>();
+    for (uint8_t m = 0; m < MEASUREMENTS; ++m) {
+      if (!isnan(values[m])) measures[measurementNames()[m]] = values[m];
+    }
+    if (ch.analyze) {
+      float interval = intervalUs(ch);
+      JsonObject harmonics = out["harmonics"][ch.name].to<JsonObject>();
+      ch.harmonics.toJson(harmonics, interval > 0.0f ? 1000000.0f / interval : 0.0f, gain);
+    }
+    if (!ch.burst) {
+      // Intervalle après décimation, pour l'axe des temps du client
+      JsonObject meta = out["meta"][ch.name].to<JsonObject>();
+      meta["mode"] = "stream";
+      meta["interval_us"] = intervalUs(ch);
+      meta["decimation"] = ch.decimation;
+      meta["acquisition"] = _average ? "average" : "sample";
+      meta["storage"] = ch.packed ? "packed" : "int16";
+      meta["capture_bytes"] = ch.packed ? ch.packedCapture.bytes() : 2 * ch.capture.size();
+      if (triggered && ch.averaged && ch.averager.mode() != ScopeAverager::MODE_OFF) {
+        JsonObject average = meta["average"].to<JsonObject>();
+        average["mode"] = ScopeAverager::modeName(ch.averager.mode());
+        average["count"] = ch.averager.count();
+        average["target"] = ch.averager.target();
+      }
+    }
+    if (triggered && ch.averager.peak() && ch.averager.peakCount()) {
+      // Enveloppe de persistance des captures brutes
+      JsonObject persistence = out["persistence"][ch.name].to<JsonObject>();
+      persistence["captures"] = ch.averager.peakCount();
+      JsonArray lo = persistence["min"].to<JsonArray>();
+      JsonArray hi = persistence["max"].to<JsonArray>();
+      for (int16_t code : ch.averager.peakMin()) lo.add(code * gain + shift);
+      for (int16_t code : ch.averager.peakMax()) hi.add(code * gain + shift);
+    }
+    if (!ch.burst) {
+      // Dernière capture complète, figée au déclenchement ou, sans
+      // déclenchement, copiée de l'anneau à chaque renouvellement
+      if (ch.packed) {
+        PackedCodes::Reader reader(ch.packedCapture);
+        for (size_t i = 0; i < ch.packedCapture.count(); ++i) buf.add(reader.next() * gain + shift);
+      } else {
+        for (int16_t code : ch.capture) {
+          buf.add(code * gain + shift);
+        }
+      }
+      continue;
+    }
+    // Rafale : vue figée du tampon, parcourue sans copie.  Si le
+    // producteur en a réécrit le début pendant la sérialisation, le
+    // tableau est repris après les points perdus : un passage de plus,
+    // jamais un retrait point par point
+    CaptureRing<int16_t>::View view = ch.ring.view();
+    uint32_t first = 0;
+    for (;;) {
+      for (uint32_t i = first; i < view.size(); ++i) {
+        buf.add(view.at(i) * gain + shift);
+      }
+      uint32_t lost = ch.ring.overwritten(view);
+      if (lost <= first) break;
+      first = lost;
+      buf.clear();
+    }
+    // Métadonnées de rafale : intervalle réellement obtenu
+    JsonObject meta = out["meta"][ch.name].to<JsonObject>();
+    meta["mode"] = ch.info.fast ? "burst_fast" : "burst";
+    meta["count"] = ch.info.count;
+    meta["rate_hz"] = ch.info.requestedRateHz;
+    meta["interval_us"] = ch.info.intervalUs;
+    meta["t_us"] = ch.info.tStartUs;
+    meta["duration_us"] = ch.info.durationUs;
+  }
+  out["timebase_ms_per_div"] = _timebaseMsPerDiv;
+  if (triggered) {
+    // État du déclenchement ; position = index du déclenchement dans la capture
+    static const char* states[] = {"off", "armed", "capturing", "stopped"};
+    JsonObject trig = out["trigger"].to<JsonObject>();
+    trig["state"] = states[_trigState];
+    trig["source"] = _channels[_trigChannel].name;
+    trig["captures"] = _captures;
+    trig["forced"] = _captureForced;
+    trig["t_us"] = _captureUs;
+    trig["position"] = _channels[_trigChannel].captureTrigger;
+    if (_segmentCount) {
+      // Compteurs de l'acquisition segmentée ; t_us : segments de la capture
+      const Channel& src = _channels[_trigChannel];
+      JsonObject seg = trig["segments"].to<JsonObject>();
+      seg["count"] = _segmentCount;
+      seg["filled"] = _segmentFill;
+      seg["length"] = src.segLength;
+      seg["pre"] = src.segPre;
+      seg["missed"] = _missed;
+      seg["rearm_us"] = _rearmUs;
+      if (_minIntervalUs != UINT32_MAX) seg["min_interval_us"] = _minIntervalUs;
+      JsonArray times = seg["t_us"].to<JsonArray>();
+      for (uint32_t t : _segmentCaptureUs) times.add(t);
     }
   }
 }
\ No newline at end of file
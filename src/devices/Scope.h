@@ -1,14 +1,16 @@
 ﻿/**
  * @file Scope.h
- * @brief Oscilloscope virtuel (squelette).
+ * @brief Oscilloscope virtuel : acquisition, déclenchement et publication des captures.
  *
- * L'oscilloscope affiche des Ã©chantillons provenant de plusieurs
- * canaux.  Cette implÃ©mentation est volontairement minimale : elle
- * prÃ©pare la structure de donnÃ©es mais ne rÃ©alise pas encore le
- * stockage temps rÃ©el ni l'affichage graphique.  Vous pouvez
- * Ã©tendre la mÃ©thode loop() pour enregistrer les Ã©chantillons dans
- * un tampon circulaire par canal et calculer la mise Ã  l'Ã©chelle
- * selon l'amplitude et l'offset.
+ * Chaque canal de scope.json suit une IO, en flux continu (échantillons
+ * du moteur d'acquisition, décimés selon la base de temps) ou en
+ * rafale (IO_A0, voir A0Burst), et conserve ses derniers codes bruts
+ * dans un anneau.  Sur déclenchement, ou à chaque renouvellement de
+ * l'anneau sans déclenchement, la capture de chaque canal est figée
+ * puis publiée par toJson() et par la trame binaire d'encodeFrame(),
+ * diffusée sur /ws/scope.  Mesures, enveloppe, moyenne, acquisition
+ * segmentée, analyse harmonique et spectre s'appuient sur ces
+ * captures ; chacun est décrit avec la fonction qui le publie.
  */
 
 #pragma once
@@ -17,20 +19,302 @@
 #include <vector>
 #include <ArduinoJson.h>
 #include "core/IORegistry.h"
+#include "core/Acquisition.h"
+#include "core/CaptureRing.h"
+#include "core/HarmonicAnalyzer.h"
+#include "core/PackedCodes.h"
+#include "ScopeAverager.h"
+#include "ScopeMeasure.h"
+#include "ScopePyramid.h"
+#include "ScopeSpectrum.h"
+#include "ScopeTrigger.h"
 
 class Scope {
 public:
+  static constexpr uint8_t FRAME_VERSION = 2;  ///< Version de la trame binaire
   static void begin();
   static void loop();
+  /**
+   * Dernière capture de chaque canal en volts, avec sous "meta"
+   * l'intervalle d'échantillonnage obtenu, le mode de stockage et la
+   * taille de la capture, sous "measurements" les mesures automatiques
+   * et sous "harmonics" l'analyse harmonique des canaux concernés.
+   *
+   * Analyse harmonique ("harmonics" : nombre d'harmoniques après la
+   * fondamentale, "harmonic_cycles" : périodes par bloc, sur un canal
+   * en flux) : chaque échantillon stocké alimente un HarmonicAnalyzer
+   * qui suit la fondamentale et publie THD, THD+N et SINAD à chaque
+   * bloc, indépendamment des captures.
+   */
   static void toJson(JsonObject& out);
+  /**
+   * Réarme le déclenchement (après une capture "single").
+   *
+   * Déclenchement (section "trigger" de scope.json, voir ScopeTrigger) :
+   * - source : nom d'un canal en flux continu ;
+   * - type : "rising", "falling", "high" ou "low" ;
+   * - level, hysteresis : seuil et hystérésis en volts ;
+   * - pre_percent : part de la capture placée avant le déclenchement ;
+   * - mode : "auto" (capture forcée si aucun déclenchement auto_ms
+   *   après le remplissage de la pré-capture), "normal" (attend un
+   *   déclenchement) ou "single" (une capture puis arrêt jusqu'à arm()).
+   * Le seuil est testé sur chaque échantillon de la source.  Au
+   * déclenchement, chaque canal en flux est aligné sur le même instant
+   * puis figé, dès que ses échantillons postérieurs sont arrivés, dans
+   * un tampon de capture distinct : l'acquisition continue dans
+   * l'anneau et la dernière capture complète reste stable d'un appel
+   * de toJson() à l'autre.
+   */
+  static void arm();
+  /** Nombre de divisions horizontales d'une capture. */
+  static const uint8_t DIVISIONS = 10;
+  /**
+   * Relit la base de temps, le mode d'acquisition et la période des
+   * rafales de scope.json et les applique aux canaux existants, sans
+   * les recréer : les anneaux et les captures, dont l'intervalle ne
+   * correspond plus, sont vidés et le déclenchement réarmé.
+   *
+   * "timebase_ms_per_div" fixe la durée d'une capture (DIVISIONS
+   * divisions) et donc l'intervalle visé, capture / buffer_size.  Un
+   * canal en flux plus rapide est décimé d'un facteur entier :
+   * "acquisition": "average" (défaut) conserve la moyenne de chaque
+   * groupe, "sample" son dernier échantillon.  Un canal en rafale sans
+   * "burst_rate_hz" capture à la cadence visée.  L'intervalle
+   * réellement obtenu est publié avec chaque capture.
+   */
+  static void applyTimebase();
+  /** Numéro de la dernière capture complète (change à chaque nouvelle trame). */
+  static uint32_t frameSeq() { return _frames; }
+  /**
+   * Sérialise la dernière capture de chaque canal en trame binaire,
+   * petit-boutiste :
+   * - en-tête de 16 octets : "MLSF", version (u8), nombre de canaux
+   *   (u8), drapeaux (u8 : bit 0 déclenchement configuré, bit 1 capture
+   *   forcée, bit 2 capture moyennée), captures moyennées de la source
+   *   (u8, au plus 255, 0 sans moyenne), numéro de trame (u32),
+   *   horodatage du déclenchement en µs (u32) ;
+   * - pour chaque canal : nombre d'échantillons (u16), index du
+   *   déclenchement (u16, 0xFFFF sans déclenchement), gain et décalage
+   *   (f32 : valeur = code × gain + décalage, comme toJson()),
+   *   intervalle d'échantillonnage en µs (f32), les MEASUREMENTS
+   *   mesures (f32, NaN si indéterminée), longueur du nom (u8) et nom ;
+   *   un octet nul complète la section à une longueur paire ;
+   * - les codes (i16) de chaque canal, dans l'ordre des canaux.
+   * Une trame est produite à chaque capture complète : déclenchement,
+   * rafale, ou renouvellement complet de l'anneau sans déclenchement.
+   */
+  static void encodeFrame(std::vector<uint8_t>& out);
+  /**
+   * Nombre de mesures automatiques par canal (ScopeMeasure), tenues à
+   * jour à coût constant par chaque échantillon stocké, sur la dernière
+   * fenêtre complète de la taille de la capture ; en volts, hertz,
+   * microsecondes et pourcentage.
+   */
+  static const uint8_t MEASUREMENTS = 10;
+  /** Noms des mesures, dans l'ordre de la trame : vmin, vmax, vpp, mean, rms, ... */
+  static const char* const* measurementNames();
+  /** Largeur maximale d'une enveloppe, en colonnes. */
+  static const uint16_t MAX_ENVELOPE_WIDTH = 1024;
+  /**
+   * Enveloppe min/max des échantillons [start, start + count) de la
+   * dernière capture du canal `name` sur `width` colonnes (count = 0 :
+   * jusqu'à la fin).  Retourne false et renseigne `error` si le canal
+   * est inconnu ou la fenêtre invalide.  Chaque capture est résumée par
+   * une pyramide min/max (ScopePyramid) : les impulsions brèves restent
+   * visibles quelle que soit la largeur.
+   */
+  static bool envelope(const String& name, uint32_t start, uint32_t count, uint16_t width,
+                       JsonObject& out, String& error);
+  /**
+   * Relit la section "average" de scope.json et reconfigure les
+   * accumulateurs des canaux en flux, qui repartent de zéro.
+   *
+   * "mode" ("off", "running" ou "exponential") et "count" règlent la
+   * moyenne des captures déclenchées, "peak_detect" et "persistence"
+   * l'enveloppe min/max des captures brutes (ScopeAverager).  La trace
+   * moyennée remplace la capture partout (toJson(), trame, enveloppe,
+   * spectre), sauf pour les captures forcées, vides ou closes par le
+   * délai avant leur dernier segment, publiées brutes et hors moyenne ;
+   * toJson() publie le nombre de captures moyennées sous "meta" et
+   * l'enveloppe sous "persistence".  Les accumulateurs de
+   * tous les canaux tiennent dans AVERAGE_HEAP_BUDGET octets : "count"
+   * est réduit au besoin.
+   */
+  static void applyAverage();
+  static constexpr uint8_t SPECTRUM_VERSION = 1;  ///< Version de la trame de spectre
+  /**
+   * Relit la section "spectrum" de scope.json ; mode inactif : les
+   * tampons de la transformée sont libérés.
+   *
+   * "enabled", "channel", "size" (256 à 2048), "window" ("hann",
+   * "flattop" ou "blackman_harris") et "peaks" : à chaque capture
+   * complète, les derniers codes du canal passent par la FFT Q15 de
+   * ScopeSpectrum.
+   */
+  static void applySpectrum();
+  /** Numéro du dernier spectre calculé. */
+  static uint32_t spectrumSeq() { return _spectra; }
+  /**
+   * Sérialise le dernier spectre en trame binaire, diffusée elle aussi
+   * sur /ws/scope, petit-boutiste :
+   * - en-tête de 16 octets : "MLSP", version (u8), fenêtre (u8, dans
+   *   l'ordre de FixedFft::Window), nombre de pics (u8), longueur du nom
+   *   du canal (u8), numéro du spectre (u32), points de la transformée
+   *   (u16), réservé (u16) ;
+   * - largeur d'une raie en Hz (f32) ;
+   * - pour chaque pic : fréquence en Hz et niveau en dBFS (f32) ;
+   * - nom du canal, complété d'un octet nul à une longueur paire ;
+   * - niveau des points / 2 raies en centièmes de dBFS (i16).
+   */
+  static void encodeSpectrum(std::vector<uint8_t>& out);
+  /** Dernier spectre en dBFS et ses pics ; false si le mode spectre est inactif. */
+  static bool spectrumToJson(JsonObject& out);
+  static const uint16_t MAX_SEGMENTS = 64;
+  static constexpr uint8_t SEGMENTS_VERSION = 1;  ///< Version du bloc de segments
+  /**
+   * Dernière séquence segmentée complète ; vide sans acquisition
+   * segmentée.
+   *
+   * Avec "segments" (2 à MAX_SEGMENTS) dans "trigger", la capture de
+   * chaque canal en flux est partagée en segments de buffer_size /
+   * segments échantillons, chacun rempli sur son propre déclenchement
+   * et horodaté ; le mode auto ne force aucun segment.  Une séquence
+   * complète remplace la capture (segments bout à bout).  Bloc
+   * petit-boutiste :
+   * - en-tête de 16 octets : "MLSG", version (u8), nombre de canaux
+   *   (u8), nombre de segments (u16), numéro de la séquence (u32),
+   *   horodatage du premier segment en µs (u32) ;
+   * - pour chaque canal : longueur d'un segment (u16), index du
+   *   déclenchement dans le segment (u16), gain, décalage et intervalle
+   *   en µs (f32, comme la trame "MLSF"), longueur du nom (u8) et nom ;
+   *   un octet nul complète la section à une longueur paire ;
+   * - pour chaque segment : horodatage du déclenchement en µs (u32),
+   *   écart avec le segment précédent en µs (u32, 0 pour le premier),
+   *   puis les codes (i16) de chaque canal, dans l'ordre des canaux.
+   */
+  static void encodeSegments(std::vector<uint8_t>& out);
 private:
+  /**
+   * Les codes sont conservés bruts (i16) ; gain et décalage ne sont
+   * appliqués qu'à la sérialisation.  L'anneau ("buffer_size", 4096 au
+   * plus) est arrondi à la puissance de deux supérieure : un ajout
+   * coûte le même temps quelle que soit sa taille.
+   */
   struct Channel {
     String name;
-    IOBase* io;
+    IOHandle io;
+    Acquisition::Reader reader;
     float amplitude;
     float offset;
-    size_t bufferSize;
-    std::vector<float> buffer;
+    CaptureRing<int16_t> ring;     ///< Codes bruts, convertis dans toJson()
+    bool burst;                    ///< "mode": "burst" : tampon rempli par rafales (IO_A0)
+    uint32_t burstRateHz;          ///< Cadence demandée (0 = au plus vite)
+    bool burstTimebase;            ///< Cadence de rafale déduite de la base de temps
+    uint16_t decimation;           ///< Échantillons du moteur par échantillon stocké
+    uint16_t decimCount;
+    int32_t decimSum;
+    bool burstFast;                ///< Rafale system_adc_read_fast(), WiFi suspendu
+    BurstInfo info;                ///< Métadonnées de la dernière rafale
+    uint16_t pre;                  ///< Échantillons avant le déclenchement
+    std::vector<int16_t> pending;  ///< Capture en cours de figeage
+    std::vector<int16_t> capture;  ///< Dernière capture complète
+    bool packed;                   ///< Capture conservée dans packedCapture
+    PackedCodes packedCapture;     ///< Dernière capture compactée (capture vide)
+    uint16_t captureTrigger;       ///< Index du déclenchement dans capture
+    uint16_t pendingTrigger;
+    uint32_t trigSeq;              ///< Séquence du déclenchement dans ring
+    bool located;                  ///< trigSeq trouvé pour la capture en cours
+    bool frozen;                   ///< pending complet
+    ScopePyramid pyramid;          ///< Résumé min/max de la dernière capture
+    ScopeMeasure measure;          ///< Mesures automatiques incrémentales
+    uint16_t segLength;            ///< Échantillons par segment
+    uint16_t segPre;               ///< Échantillons d'un segment avant son déclenchement
+    std::vector<uint32_t> segTrig; ///< Séquence du déclenchement de chaque segment dans ring
+    uint16_t segLocated;           ///< Segments dont le déclenchement est situé
+    uint16_t segDone;              ///< Segments copiés dans pending
+    ScopeAverager averager;        ///< Moyenne et crête des captures déclenchées
+    bool averaged;                 ///< capture est la trace moyennée
+    bool analyze;                  ///< Analyse harmonique active
+    HarmonicAnalyzer harmonics;
   };
+  enum TrigState : uint8_t { TRIG_OFF, TRIG_ARMING, TRIG_CAPTURING, TRIG_STOPPED };
+  /** Délai, au-delà de la durée d'une capture, après lequel elle est close sans les canaux en retard. */
+  static const uint32_t CAPTURE_TIMEOUT_MS = 1000;
+  /** Tas réservé aux accumulateurs de moyenne, tous canaux confondus. */
+  static const size_t AVERAGE_HEAP_BUDGET = 12288;
   static std::vector<Channel> _channels;
+  static float _timebaseMsPerDiv;
+  static bool _average;            ///< Décimation par moyenne (sinon sous-échantillonnage)
+  static uint32_t _captureTimeoutMs;  ///< CAPTURE_TIMEOUT_MS + durée de la capture la plus longue
+  static uint32_t _burstPeriodMs;  ///< Intervalle entre deux rafales
+  static uint32_t _lastBurstMs;
+  static ScopeTrigger _trigger;
+  static ScopeTrigger::Mode _trigMode;
+  static TrigState _trigState;
+  static int _trigChannel;         ///< Canal source (-1 : sans déclenchement)
+  static uint32_t _autoMs;
+  static uint32_t _armSeq;         ///< Séquence de la source au réarmement
+  static uint32_t _armMs;          ///< Réarmement, puis fin de la pré-capture
+  static bool _preFilled;
+  static uint32_t _fireMs;
+  static uint32_t _trigUs;         ///< Horodatage du déclenchement en cours
+  static uint32_t _lastSourceUs;
+  static bool _forced;             ///< Capture en cours forcée (mode auto)
+  static uint32_t _captures;
+  static bool _captureForced;
+  static uint32_t _captureUs;
+  static uint32_t _frames;
+  static int _rollChannel;         ///< Canal de référence sans déclenchement
+  static uint32_t _rollSeq;        ///< Sa séquence à la dernière trame
+  static uint16_t _segmentCount;   ///< Segments par séquence (0 : capture unique)
+  static uint16_t _segmentFill;    ///< Segments déclenchés de la séquence en cours
+  static std::vector<uint32_t> _segmentUs;         ///< Horodatage des segments en cours
+  static std::vector<uint32_t> _segmentCaptureUs;  ///< Horodatage des segments de la capture
+  static uint32_t _segmentEnd;     ///< Séquence de la source à la fin du segment en cours
+  static uint32_t _segmentEndUs;
+  static bool _holdoff;            ///< Segment en cours : seuil testé pour compter les manqués
+  static uint32_t _missed;
+  static uint32_t _rearmUs;        ///< Temps mort mesuré entre deux segments
+  static uint32_t _minIntervalUs;  ///< Plus court écart entre deux segments
+  static ScopeSpectrum _spectrum;
+  static int _spectrumChannel;     ///< Canal analysé (-1 : mode spectre inactif)
+  static uint32_t _spectrumFrame;  ///< Trame du dernier spectre calculé
+  static uint32_t _spectra;
+  static uint32_t _spectrumUs;     ///< Durée du dernier calcul
+  /** Vide l'anneau d'un canal en flux et y suit le déclenchement. */
+  static void stream(Channel& ch, bool source);
+  static void rearm();
+  static void fire(uint32_t tUs, bool forced);
+  static void freeze(Channel& ch);
+  /** Codes de la dernière capture complète du canal ; capture compactée décodée dans `scratch`. */
+  static const int16_t* captureData(const Channel& ch, uint32_t& count,
+                                    std::vector<int16_t>& scratch);
+  /** Échantillons de la dernière capture complète d'un canal en flux. */
+  static uint32_t captureCount(const Channel& ch);
+  /**
+   * Construit la pyramide de la capture puis, avec "storage": "packed",
+   * la compacte (PackedCodes, environ un octet par échantillon pour un
+   * signal lent) et libère les deux copies i16 : la capture en cours
+   * n'est allouée que le temps de la figer.
+   */
+  static void storeCapture(Channel& ch);
+  /** Code → valeur affichée : code × gain + shift (amplitude et offset du canal). */
+  static void scaling(const Channel& ch, float& gain, float& shift);
+  /** Mesures du canal en unités physiques, NaN si indéterminées. */
+  static void measurements(const Channel& ch, float* out);
+  /** Intervalle d'échantillonnage du canal en µs (0 si inconnu). */
+  static float intervalUs(const Channel& ch);
+  static void complete();
+  /**
+   * Seuil d'un échantillon de la source en acquisition segmentée.  Il
+   * est de nouveau testé dès l'échantillon qui suit la fin d'un
+   * segment, la pré-capture du suivant étant déjà dans l'anneau ; les
+   * déclenchements survenus pendant un segment, ou avant que la
+   * séquence soit copiée, sont comptés comme manqués.
+   */
+  static void segmentTrigger(Channel& src, int16_t code, uint32_t tUs);
+  /** Situe et copie les segments d'un canal à mesure que leurs échantillons arrivent. */
+  static void segmentCopy(Channel& ch, uint32_t tUs);
+  static void startSequence();
+  static void completeSequence();
 };
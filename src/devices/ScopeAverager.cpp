@@ -0,0 +1,115 @@
+/**
+ * @file ScopeAverager.cpp
+ * @brief Accumulateurs de moyenne et d'enveloppe de crête.
+ */
+
+#include "ScopeAverager.h"
+
+bool ScopeAverager::parseMode(const String& name, Mode& out) {
+  if (name == "off") out = MODE_OFF;
+  else if (name == "running") out = MODE_RUNNING;
+  else if (name == "exponential") out = MODE_EXPONENTIAL;
+  else return false;
+  return true;
+}
+
+const char* ScopeAverager::modeName(Mode mode) {
+  static const char* names[] = {"off", "running", "exponential"};
+  return names[mode];
+}
+
+size_t ScopeAverager::bytes(Mode mode, uint16_t count, bool peak, uint32_t length) {
+  size_t size = 0;
+  if (mode != MODE_OFF) size += length * sizeof(int32_t);
+  if (mode == MODE_RUNNING) size += static_cast<size_t>(count) * length * sizeof(int16_t);
+  if (peak) size += 2 * length * sizeof(int16_t);
+  return size;
+}
+
+void ScopeAverager::configure(Mode mode, uint16_t count, bool peak, uint16_t persistence) {
+  if (count < 1) count = 1;
+  if (count > MAX_COUNT) count = MAX_COUNT;
+  _shift = 0;
+  if (mode == MODE_EXPONENTIAL) {
+    // Poids 1 / 2^k : divisions remplacées par des décalages
+    while ((2u << _shift) <= count) _shift++;
+    count = static_cast<uint16_t>(1u << _shift);
+  }
+  _mode = mode;
+  _count = count;
+  _peak = peak;
+  _persistence = persistence;
+  reset();
+}
+
+void ScopeAverager::reset() {
+  _length = 0;
+  _filled = 0;
+  _slot = 0;
+  _peakCount = 0;
+  // Tampons rendus au tas, réalloués à la prochaine capture
+  std::vector<int32_t>().swap(_acc);
+  std::vector<int16_t>().swap(_history);
+  std::vector<int16_t>().swap(_min);
+  std::vector<int16_t>().swap(_max);
+}
+
+void ScopeAverager::allocate(uint32_t length) {
+  reset();
+  _length = length;
+  if (_mode != MODE_OFF) _acc.assign(length, 0);
+  if (_mode == MODE_RUNNING) _history.assign(static_cast<size_t>(_count) * length, 0);
+  if (_peak) {
+    _min.resize(length);
+    _max.resize(length);
+  }
+}
+
+void ScopeAverager::add(int16_t* capture, uint32_t length) {
+  if (!active() || length == 0) return;
+  if (length != _length) allocate(length);
+  if (_peak) accumulatePeak(capture);
+  if (_mode == MODE_RUNNING) {
+    // La capture remplace la plus ancienne dans l'historique et dans les sommes
+    int16_t* slot = _history.data() + static_cast<size_t>(_slot) * length;
+    bool full = _filled == _count;
+    if (!full) _filled++;
+    int32_t n = _filled;
+    int32_t half = n / 2;
+    for (uint32_t i = 0; i < length; ++i) {
+      int32_t sum = _acc[i] + capture[i];
+      if (full) sum -= slot[i];
+      _acc[i] = sum;
+      slot[i] = capture[i];
+      capture[i] = static_cast<int16_t>((sum + (sum < 0 ? -half : half)) / n);
+    }
+    if (++_slot == _count) _slot = 0;
+  } else if (_mode == MODE_EXPONENTIAL) {
+    if (_filled < _count) _filled++;
+    // Poids 1 / 2^k avec 2^k ≤ captures reçues : moyenne pendant la montée
+    uint8_t shift = 0;
+    while (shift < _shift && (2u << shift) <= _filled) shift++;
+    int32_t round = shift ? 1 << (shift - 1) : 0;
+    const int32_t unit = 1 << FRACTION_BITS;
+    for (uint32_t i = 0; i < length; ++i) {
+      int32_t target = static_cast<int32_t>(capture[i]) * unit;
+      int32_t acc = _filled == 1 ? target : _acc[i] + ((target - _acc[i] + round) >> shift);
+      _acc[i] = acc;
+      capture[i] = static_cast<int16_t>((acc + unit / 2) >> FRACTION_BITS);
+    }
+  }
+}
+
+void ScopeAverager::accumulatePeak(const int16_t* capture) {
+  if (_peakCount == 0 || (_persistence && _peakCount >= _persistence)) {
+    // Enveloppe repartie de la capture courante
+    for (uint32_t i = 0; i < _length; ++i) _min[i] = _max[i] = capture[i];
+    _peakCount = 1;
+    return;
+  }
+  for (uint32_t i = 0; i < _length; ++i) {
+    if (capture[i] < _min[i]) _min[i] = capture[i];
+    if (capture[i] > _max[i]) _max[i] = capture[i];
+  }
+  _peakCount++;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file ScopeAverager.h
+ * @brief Moyenne et détection de crête des captures déclenchées d'un canal.
+ *
+ * add() reçoit chaque capture complète et la remplace par la trace
+ * moyennée, en un passage sur ses échantillons :
+ * - "running" : moyenne des `count` dernières captures.  Une somme
+ *   entière par échantillon et l'historique des captures (codes i16)
+ *   permettent de retirer la plus ancienne sans tout recalculer ;
+ * - "exponential" : acc += (code − acc) / 2^k, accumulateur en codes
+ *   virgule fixe (FRACTION_BITS bits de fraction), `count` arrondi à la
+ *   puissance de deux inférieure.  Pendant les premières captures, le
+ *   poids suit leur nombre pour converger aussi vite qu'une moyenne.
+ * La trace rendue est arrondie au code le plus proche : elle garde
+ * l'échelle des codes bruts (gain et décalage du canal inchangés).
+ *
+ * Détection de crête ("peak_detect") : minimum et maximum de chaque
+ * échantillon sur les captures brutes, avant moyenne, soit l'enveloppe
+ * de persistance.  Avec "persistence" > 0, l'enveloppe repart de la
+ * capture courante toutes les `persistence` captures ; à 0 elle
+ * s'accumule jusqu'à reset().
+ *
+ * Les tampons sont alloués à la première capture, à sa longueur ;
+ * bytes() donne leur taille pour que Scope les borne au budget de tas.
+ * Une capture de longueur différente repart de zéro.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+class ScopeAverager {
+public:
+  enum Mode : uint8_t { MODE_OFF, MODE_RUNNING, MODE_EXPONENTIAL };
+  static const uint16_t MAX_COUNT = 256;
+  static const uint8_t FRACTION_BITS = 8;  ///< Fraction de l'accumulateur exponentiel
+
+  /** Décode "off", "running" ou "exponential" ; false si inconnu. */
+  static bool parseMode(const String& name, Mode& out);
+  static const char* modeName(Mode mode);
+  /** Octets de tas pour `length` échantillons. */
+  static size_t bytes(Mode mode, uint16_t count, bool peak, uint32_t length);
+
+  /** Nouvelle configuration ; les accumulations en cours sont perdues. */
+  void configure(Mode mode, uint16_t count, bool peak, uint16_t persistence);
+  /** Repart de zéro en gardant la configuration. */
+  void reset();
+  bool active() const { return _mode != MODE_OFF || _peak; }
+  Mode mode() const { return _mode; }
+  /** Captures dans la moyenne courante, et leur nombre visé. */
+  uint16_t count() const { return _filled; }
+  uint16_t target() const { return _count; }
+
+  /** Accumule `capture` puis la remplace par la trace moyennée. */
+  void add(int16_t* capture, uint32_t length);
+
+  bool peak() const { return _peak; }
+  /** Captures dans l'enveloppe de crête. */
+  uint32_t peakCount() const { return _peakCount; }
+  const std::vector<int16_t>& peakMin() const { return _min; }
+  const std::vector<int16_t>& peakMax() const { return _max; }
+
+private:
+  Mode _mode = MODE_OFF;
+  uint16_t _count = 1;
+  bool _peak = false;
+  uint16_t _persistence = 0;
+  uint32_t _length = 0;
+  uint16_t _filled = 0;             ///< Captures accumulées (au plus _count)
+  uint16_t _slot = 0;               ///< Prochaine capture de l'historique à remplacer
+  uint8_t _shift = 0;               ///< log2(_count), mode exponentiel
+  std::vector<int32_t> _acc;        ///< Sommes (running) ou codes en virgule fixe
+  std::vector<int16_t> _history;    ///< _count captures bout à bout (running)
+  std::vector<int16_t> _min;
+  std::vector<int16_t> _max;
+  uint32_t _peakCount = 0;
+
+  void allocate(uint32_t length);
+  void accumulatePeak(const int16_t* capture);
+};
@@ -0,0 +1,75 @@
+/**
+ * @file ScopeMeasure.cpp
+ * @brief Fronts et publication des mesures d'une fenêtre.
+ */
+
+#include "ScopeMeasure.h"
+
+void ScopeMeasure::reset(uint32_t window) {
+  _window = window ? window : 1;
+  _levels = false;
+  _result = Result();
+  clear();
+}
+
+void ScopeMeasure::clear() {
+  _n = 0;
+  _min = INT16_MAX;
+  _max = INT16_MIN;
+  _sum = 0;
+  _sumSq = 0;
+  _rises = 0;
+  _pendingHigh = -1.0f;
+  _highSum = 0.0f;
+  _rising = false;
+  _falling = false;
+  _riseSum = 0.0f;
+  _fallSum = 0.0f;
+  _riseCount = 0;
+  _fallCount = 0;
+}
+
+void ScopeMeasure::rise() {
+  _high = true;
+  if (_rises == 0) _firstRise = _tUp;
+  // La durée haute de la période précédente n'est retenue qu'une fois
+  // celle-ci complète
+  if (_pendingHigh >= 0.0f) _highSum += _pendingHigh;
+  _pendingHigh = -1.0f;
+  _lastRise = _tUp;
+  _rises++;
+}
+
+void ScopeMeasure::fall() {
+  _high = false;
+  if (_rises > 0) _pendingHigh = _tDown - _lastRise;
+}
+
+void ScopeMeasure::publish() {
+  Result r;
+  r.valid = true;
+  r.min = _min;
+  r.max = _max;
+  r.mean = static_cast<float>(_sum) / _n;
+  r.meanSquare = static_cast<float>(_sumSq) / _n;
+  if (_rises >= 2) {
+    float span = _lastRise - _firstRise;
+    r.period = span / (_rises - 1);
+    r.duty = _highSum / span;
+  }
+  if (_riseCount) r.rise = _riseSum / _riseCount;
+  if (_fallCount) r.fall = _fallSum / _fallCount;
+  _result = r;
+
+  // Seuils de la fenêtre suivante
+  int32_t span = static_cast<int32_t>(_max) - _min;
+  _levels = span >= MIN_SPAN;
+  _lo = _min + span / 10;
+  _hi = _max - span / 10;
+  _mid = _min + span / 2;
+  _hyst = span / 20;
+  _high = _prev >= _mid;
+  _tUp = 0.0f;
+  _tDown = 0.0f;
+  clear();
+}
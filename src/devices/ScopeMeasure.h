@@ -0,0 +1,137 @@
+/**
+ * @file ScopeMeasure.h
+ * @brief Mesures automatiques incrémentales d'un canal de l'oscilloscope.
+ *
+ * push() est appelée pour chaque échantillon stocké et ne fait qu'un
+ * nombre fixe de comparaisons et d'additions entières : minimum,
+ * maximum, somme et somme des carrés, puis passages des seuils à 10 %,
+ * 50 % et 90 % de l'amplitude.  Les instants de passage, interpolés
+ * entre deux échantillons, ne sont calculés qu'aux passages.
+ *
+ * Les mesures portent sur une fenêtre de `window` échantillons (la
+ * taille de la capture) : à la fin de chaque fenêtre, le résultat est
+ * publié puis les accumulateurs repartent de zéro.  Les seuils d'une
+ * fenêtre sont déduits du minimum et du maximum de la précédente ;
+ * fréquence, rapport cyclique et temps de montée ou de descente ne
+ * sont donc connus qu'à partir de la deuxième fenêtre.
+ * - période : écart moyen entre fronts montants au seuil de 50 %,
+ *   confirmés par une hystérésis de 5 % de l'amplitude ;
+ * - rapport cyclique : durée à l'état haut sur les périodes complètes ;
+ * - montée (descente) : moyenne des durées entre les seuils de 10 % et
+ *   90 % (90 % et 10 %).
+ * Toutes les grandeurs sont en codes et en échantillons ; Scope les
+ * convertit en volts et en microsecondes.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class ScopeMeasure {
+public:
+  /** Amplitude minimale, en codes, pour mesurer des fronts. */
+  static const int32_t MIN_SPAN = 4;
+
+  struct Result {
+    bool valid = false;   ///< Au moins une fenêtre complète
+    int16_t min = 0;
+    int16_t max = 0;
+    float mean = 0.0f;        ///< Moyenne des codes
+    float meanSquare = 0.0f;  ///< Moyenne des carrés des codes
+    float period = 0.0f;      ///< En échantillons, 0 si indéterminée
+    float duty = -1.0f;       ///< Entre 0 et 1, négatif si indéterminé
+    float rise = 0.0f;        ///< En échantillons, 0 si indéterminée
+    float fall = 0.0f;
+  };
+
+  /** Repart de zéro avec des fenêtres de `window` échantillons. */
+  void reset(uint32_t window);
+  const Result& result() const { return _result; }
+
+  /** Ajoute un échantillon (coût constant). */
+  void push(int16_t code) {
+    if (code < _min) _min = code;
+    if (code > _max) _max = code;
+    _sum += code;
+    _sumSq += static_cast<uint32_t>(static_cast<int32_t>(code) * code);
+    if (_levels) track(code);
+    _prev = code;
+    if (++_n >= _window) publish();
+  }
+
+private:
+  uint32_t _window = 0;
+  uint32_t _n = 0;
+  int16_t _min = 0;
+  int16_t _max = 0;
+  int16_t _prev = 0;
+  int32_t _sum = 0;
+  uint64_t _sumSq = 0;
+
+  // Seuils issus de la fenêtre précédente
+  bool _levels = false;
+  int32_t _lo = 0;
+  int32_t _mid = 0;
+  int32_t _hi = 0;
+  int32_t _hyst = 0;
+
+  // Fronts au seuil de 50 %
+  bool _high = false;
+  float _tUp = 0.0f;
+  float _tDown = 0.0f;
+  uint32_t _rises = 0;
+  float _firstRise = 0.0f;
+  float _lastRise = 0.0f;
+  float _pendingHigh = -1.0f;  ///< Durée haute de la période en cours
+  float _highSum = 0.0f;
+
+  // Montée et descente entre 10 % et 90 %
+  bool _rising = false;
+  bool _falling = false;
+  float _t10 = 0.0f;
+  float _t90 = 0.0f;
+  float _riseSum = 0.0f;
+  float _fallSum = 0.0f;
+  uint16_t _riseCount = 0;
+  uint16_t _fallCount = 0;
+
+  Result _result;
+
+  /** Passages des seuils : quelques comparaisons, interpolation aux passages seulement. */
+  void track(int16_t code) {
+    if (_prev < _lo && code >= _lo) {
+      _t10 = crossing(_lo, code);
+      _rising = true;
+    }
+    if (_prev < _hi && code >= _hi && _rising) {
+      _riseSum += crossing(_hi, code) - _t10;
+      _riseCount++;
+      _rising = false;
+    }
+    if (_prev > _hi && code <= _hi) {
+      _t90 = crossing(_hi, code);
+      _falling = true;
+    }
+    if (_prev > _lo && code <= _lo && _falling) {
+      _fallSum += crossing(_lo, code) - _t90;
+      _fallCount++;
+      _falling = false;
+    }
+    if (!_high) {
+      if (_prev < _mid && code >= _mid) _tUp = crossing(_mid, code);
+      if (code >= _mid + _hyst) rise();
+    } else {
+      if (_prev > _mid && code <= _mid) _tDown = crossing(_mid, code);
+      if (code <= _mid - _hyst) fall();
+    }
+  }
+  /** Instant (en échantillons) où le segment _prev → code atteint `level`. */
+  float crossing(int32_t level, int16_t code) const {
+    return static_cast<float>(static_cast<int32_t>(_n) - 1) +
+           static_cast<float>(level - _prev) / (code - _prev);
+  }
+  void rise();
+  void fall();
+  void publish();
+  void clear();
+};
@@ -0,0 +1,97 @@
+/**
+ * @file ScopePyramid.cpp
+ * @brief Construction et lecture de la pyramide min/max.
+ */
+
+#include "ScopePyramid.h"
+
+void ScopePyramid::build(const int16_t* data, size_t count) {
+  _count = static_cast<uint32_t>(count);
+  _offsets.clear();
+  // Taille totale : n/4 + n/16 + ... paquets, deux codes par paquet
+  size_t pairs = 0;
+  for (size_t n = count; n > 1;) {
+    n = (n + (1u << FACTOR_LOG2) - 1) >> FACTOR_LOG2;
+    pairs += n;
+  }
+  _minmax.resize(2 * pairs);
+
+  const uint32_t factor = 1u << FACTOR_LOG2;
+  uint32_t out = 0;
+  uint32_t n = _count;
+  // Niveau 1 depuis les codes
+  if (n > 1) {
+    _offsets.push_back(0);
+    for (uint32_t i = 0; i < n; i += factor) {
+      int16_t lo = data[i];
+      int16_t hi = data[i];
+      uint32_t end = i + factor < n ? i + factor : n;
+      for (uint32_t j = i + 1; j < end; ++j) {
+        if (data[j] < lo) lo = data[j];
+        if (data[j] > hi) hi = data[j];
+      }
+      _minmax[2 * out] = lo;
+      _minmax[2 * out + 1] = hi;
+      out++;
+    }
+    n = out - _offsets.back();
+  }
+  // Niveaux suivants depuis le précédent
+  while (n > 1) {
+    uint32_t prev = _offsets.back();
+    _offsets.push_back(out);
+    for (uint32_t i = 0; i < n; i += factor) {
+      int16_t lo = _minmax[2 * (prev + i)];
+      int16_t hi = _minmax[2 * (prev + i) + 1];
+      uint32_t end = i + factor < n ? i + factor : n;
+      for (uint32_t j = i + 1; j < end; ++j) {
+        if (_minmax[2 * (prev + j)] < lo) lo = _minmax[2 * (prev + j)];
+        if (_minmax[2 * (prev + j) + 1] > hi) hi = _minmax[2 * (prev + j) + 1];
+      }
+      _minmax[2 * out] = lo;
+      _minmax[2 * out + 1] = hi;
+      out++;
+    }
+    n = out - _offsets.back();
+  }
+}
+
+uint8_t ScopePyramid::envelope(const int16_t* data, uint32_t start, uint32_t count,
+                               uint16_t width, int16_t* mins, int16_t* maxs) const {
+  if (width == 0 || count == 0) return 0;
+  if (count < width) width = static_cast<uint16_t>(count);
+  // Niveau le plus grossier dont un paquet tient dans un pixel
+  uint8_t level = 0;
+  while (level < _offsets.size() &&
+         (static_cast<uint32_t>(width) << (FACTOR_LOG2 * (level + 1))) <= count) {
+    level++;
+  }
+  uint8_t shift = FACTOR_LOG2 * level;
+  for (uint16_t px = 0; px < width; ++px) {
+    // Codes [a, b) du pixel, sans dérive d'arrondi d'un pixel à l'autre
+    uint32_t a = start + static_cast<uint32_t>(static_cast<uint64_t>(count) * px / width);
+    uint32_t b = start + static_cast<uint32_t>(static_cast<uint64_t>(count) * (px + 1) / width);
+    int16_t lo;
+    int16_t hi;
+    if (level == 0) {
+      lo = hi = data[a];
+      for (uint32_t i = a + 1; i < b; ++i) {
+        if (data[i] < lo) lo = data[i];
+        if (data[i] > hi) hi = data[i];
+      }
+    } else {
+      const int16_t* pairs = _minmax.data() + 2 * _offsets[level - 1];
+      uint32_t first = a >> shift;
+      uint32_t last = (b - 1) >> shift;
+      lo = pairs[2 * first];
+      hi = pairs[2 * first + 1];
+      for (uint32_t k = first + 1; k <= last; ++k) {
+        if (pairs[2 * k] < lo) lo = pairs[2 * k];
+        if (pairs[2 * k + 1] > hi) hi = pairs[2 * k + 1];
+      }
+    }
+    mins[px] = lo;
+    maxs[px] = hi;
+  }
+  return level;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file ScopePyramid.h
+ * @brief Pyramide de décimation min/max d'une capture de l'oscilloscope.
+ *
+ * Le niveau k (k ≥ 1) résume la capture par paquets de 4^k
+ * échantillons : pour chaque paquet, le minimum et le maximum des
+ * codes.  Le niveau 0 est la capture elle-même, qui n'est pas copiée.
+ * L'ensemble des niveaux occupe au plus deux tiers de la capture et se
+ * construit en un passage par niveau, chaque niveau étant déduit du
+ * précédent.
+ *
+ * envelope() répond à une fenêtre quelconque de la capture rendue sur
+ * `width` pixels : elle choisit le niveau le plus grossier dont les
+ * paquets ne dépassent pas la part d'un pixel, puis combine au plus
+ * quelques paquets par pixel.  Un paquet à cheval sur deux pixels
+ * compte pour les deux : l'enveloppe peut s'élargir d'un paquet mais
+ * ne perd jamais une impulsion, contrairement à un sous-échantillonnage.
+ * Le coût et la taille de la réponse dépendent de `width`, non de la
+ * longueur de la capture.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class ScopePyramid {
+public:
+  static const uint8_t FACTOR_LOG2 = 2;  ///< Paquets de 4 paquets du niveau précédent
+
+  /** Reconstruit les niveaux pour `count` codes (le tableau reste à l'appelant). */
+  void build(const int16_t* data, size_t count);
+  /** Nombre de codes de la capture résumée. */
+  size_t count() const { return _count; }
+  /** Nombre de niveaux, capture comprise. */
+  uint8_t levels() const { return static_cast<uint8_t>(_offsets.size() + 1); }
+
+  /**
+   * Enveloppe des codes [start, start + count) de `data` (le tableau
+   * passé à build()) sur `width` colonnes : mins[i] et maxs[i] pour
+   * la colonne i.  Retourne le niveau utilisé.  Si `count` < `width`,
+   * une colonne par code.
+   */
+  uint8_t envelope(const int16_t* data, uint32_t start, uint32_t count, uint16_t width,
+                   int16_t* mins, int16_t* maxs) const;
+
+private:
+  std::vector<int16_t> _minmax;    ///< Couples (min, max) de tous les niveaux ≥ 1
+  std::vector<uint32_t> _offsets;  ///< Premier couple du niveau k + 1
+  uint32_t _count = 0;
+};
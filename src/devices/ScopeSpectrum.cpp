@@ -0,0 +1,92 @@
+/**
+ * @file ScopeSpectrum.cpp
+ * @brief Fenêtrage, transformée et recherche des pics.
+ */
+
+#include "ScopeSpectrum.h"
+
+#include <math.h>
+
+void ScopeSpectrum::configure(uint16_t size, FixedFft::Window window, uint8_t peaks) {
+  _size = size;
+  _window = window;
+  _maxPeaks = peaks > MAX_PEAKS ? MAX_PEAKS : peaks;
+  _points = 0;
+  _peaks.clear();
+  _peaks.reserve(_maxPeaks);
+  _re.assign(size, 0);
+  _im.assign(size, 0);
+}
+
+void ScopeSpectrum::release() {
+  _points = 0;
+  _peaks.clear();
+  std::vector<int16_t>().swap(_re);
+  std::vector<int16_t>().swap(_im);
+}
+
+bool ScopeSpectrum::compute(const int16_t* codes, uint32_t count, int32_t codeMin,
+                            int32_t codeMax, float intervalUs) {
+  uint16_t n = _size;
+  while (n > count && n > FixedFft::MIN_SIZE) n >>= 1;
+  if (n > count || _re.size() < n || !(intervalUs > 0.0f)) {
+    _points = 0;
+    _peaks.clear();
+    return false;
+  }
+  codes += count - n;
+
+  // Centrage sur la plage de l'IO puis décalage jusqu'à 15 bits
+  int32_t mid = (codeMin + codeMax) / 2;
+  int32_t half = (codeMax - codeMin) / 2;
+  if (half < 1) half = 1;
+  uint8_t shift = 0;
+  while ((half << (shift + 1)) <= 32767) shift++;
+  for (uint16_t i = 0; i < n; ++i) {
+    int32_t x = (static_cast<int32_t>(codes[i]) - mid) << shift;
+    if (x > 32767) x = 32767;
+    if (x < -32768) x = -32768;
+    _re[i] = static_cast<int16_t>((x * FixedFft::window(_window, i, n) + (1 << 14)) >> 15);
+    _im[i] = 0;
+  }
+  FixedFft::transform(_re.data(), _im.data(), n);
+
+  // Une sinusoïde pleine échelle donne une raie de half·2^shift·gain/2
+  float reference = (static_cast<float>(half << shift) * FixedFft::coherentGain(_window)) / 65536.0f;
+  int32_t offset = lroundf(2000.0f * log10f(reference));
+  for (uint16_t k = 0; k < n / 2; ++k) {
+    int32_t level = FixedFft::powerCentiDb(_re[k], _im[k]) - offset;
+    _re[k] = static_cast<int16_t>(level < FixedFft::FLOOR_CENTI_DB ? FixedFft::FLOOR_CENTI_DB : level);
+  }
+  _points = n;
+  _binHz = 1000000.0f / (intervalUs * n);
+  findPeaks();
+  return true;
+}
+
+void ScopeSpectrum::findPeaks() {
+  const int16_t* level = _re.data();
+  uint16_t bins = _points / 2;
+  // Maxima locaux triés par niveau décroissant, au plus _maxPeaks
+  std::vector<uint16_t> best;
+  best.reserve(_maxPeaks + 1);
+  for (uint16_t k = 1; k + 1 < bins; ++k) {
+    if (level[k] <= level[k - 1] || level[k] < level[k + 1]) continue;
+    if (best.size() == _maxPeaks && level[k] <= level[best.back()]) continue;
+    size_t pos = best.size();
+    while (pos > 0 && level[best[pos - 1]] < level[k]) pos--;
+    best.insert(best.begin() + pos, k);
+    if (best.size() > _maxPeaks) best.pop_back();
+  }
+  _peaks.clear();
+  for (uint16_t k : best) {
+    float a = level[k - 1] / 100.0f;
+    float b = level[k] / 100.0f;
+    float c = level[k + 1] / 100.0f;
+    float den = a - 2.0f * b + c;
+    float delta = den < 0.0f ? 0.5f * (a - c) / den : 0.0f;
+    // Le sommet plat de la flat-top rend la correction de niveau inutile
+    float dbfs = _window == FixedFft::WINDOW_FLATTOP ? b : b - 0.25f * (a - c) * delta;
+    _peaks.push_back({(k + delta) * _binHz, dbfs});
+  }
+}
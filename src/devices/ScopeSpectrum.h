@@ -0,0 +1,74 @@
+/**
+ * @file ScopeSpectrum.h
+ * @brief Spectre d'amplitude d'une capture de l'oscilloscope.
+ *
+ * compute() prend les derniers codes d'une capture, retire le milieu de
+ * la plage de l'IO, les amplifie d'un décalage entier pour occuper les
+ * 16 bits, applique la fenêtre puis la FFT Q15 de FixedFft.  Chaque
+ * raie 0..N/2 − 1 est convertie en centièmes de dBFS, en place dans le
+ * tampon de la partie réelle : 0 dBFS correspond à une sinusoïde
+ * couvrant toute la plage de l'IO (codeMin() à codeMax()), gain
+ * cohérent de la fenêtre compensé.  Seul le décalage de référence est
+ * calculé en flottant, une fois par transformée.
+ *
+ * Les pics sont les maxima locaux les plus élevés ; fréquence et niveau
+ * sont affinés par interpolation parabolique sur les trois raies en dB,
+ * sauf le niveau avec la fenêtre flat-top, déjà juste à 0,02 dB près
+ * quelle que soit la position du pic entre deux raies.
+ *
+ * La dynamique est limitée par l'arithmétique 16 bits et la division
+ * par deux de chaque étage : sous une sinusoïde pleine échelle, les
+ * raies parasites restent vers −65 dBFS (flat-top) à −70 dBFS (Hann,
+ * Blackman-Harris).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "core/FixedFft.h"
+
+class ScopeSpectrum {
+public:
+  static const uint8_t MAX_PEAKS = 16;
+
+  struct Peak {
+    float hz;
+    float dbfs;
+  };
+
+  /** Taille visée (puissance de deux), fenêtre et nombre de pics publiés. */
+  void configure(uint16_t size, FixedFft::Window window, uint8_t peaks);
+  /** Libère les tampons. */
+  void release();
+  uint16_t size() const { return _size; }
+  FixedFft::Window window() const { return _window; }
+
+  /**
+   * Transforme les min(size(), 2^k ≤ count) derniers codes ; false si
+   * la capture compte moins de FixedFft::MIN_SIZE codes.  codeMin et
+   * codeMax sont les bornes de l'IO, intervalUs l'intervalle entre
+   * deux codes.
+   */
+  bool compute(const int16_t* codes, uint32_t count, int32_t codeMin, int32_t codeMax,
+               float intervalUs);
+
+  /** Points de la dernière transformée (0 si aucune). */
+  uint16_t points() const { return _points; }
+  /** Niveau des raies 0..points()/2 − 1 en centièmes de dBFS. */
+  const int16_t* bins() const { return _re.data(); }
+  float binHz() const { return _binHz; }
+  const std::vector<Peak>& peaks() const { return _peaks; }
+
+private:
+  uint16_t _size = 1024;
+  FixedFft::Window _window = FixedFft::WINDOW_HANN;
+  uint8_t _maxPeaks = 5;
+  uint16_t _points = 0;
+  float _binHz = 0.0f;
+  std::vector<int16_t> _re;  ///< Partie réelle, puis niveaux des raies
+  std::vector<int16_t> _im;
+  std::vector<Peak> _peaks;
+
+  void findPeaks();
+};
@@ -0,0 +1,93 @@
+/**
+ * @file ScopeTrigger.h
+ * @brief Détection de déclenchement de l'oscilloscope.
+ *
+ * Le seuil et l'hystérésis sont convertis une fois en codes natifs de
+ * l'IO source : test() ne fait ensuite qu'une ou deux comparaisons
+ * entières par échantillon, ce qui permet de l'appeler sur chaque
+ * échantillon à la cadence maximale du moteur d'acquisition.
+ *
+ * - "rising" : le signal doit d'abord passer sous seuil − hystérésis
+ *   (armement) puis atteindre le seuil ;
+ * - "falling" : symétrique, au-dessus de seuil + hystérésis puis
+ *   jusqu'au seuil ;
+ * - "high" / "low" : déclenchement de niveau, dès qu'un échantillon
+ *   est au-dessus (au-dessous) du seuil, sans franchissement.
+ * L'hystérésis évite qu'un bruit autour du seuil ne produise des
+ * déclenchements sur de faux fronts.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class ScopeTrigger {
+public:
+  enum Type : uint8_t { EDGE_RISING, EDGE_FALLING, LEVEL_HIGH, LEVEL_LOW };
+  enum Mode : uint8_t { MODE_AUTO, MODE_NORMAL, MODE_SINGLE };
+
+  /** Décode "rising", "falling", "high" ou "low" ; false si inconnu. */
+  static bool parseType(const String& name, Type& out) {
+    if (name == "rising") out = EDGE_RISING;
+    else if (name == "falling") out = EDGE_FALLING;
+    else if (name == "high") out = LEVEL_HIGH;
+    else if (name == "low") out = LEVEL_LOW;
+    else return false;
+    return true;
+  }
+  /** Décode "auto", "normal" ou "single" ; false si inconnu. */
+  static bool parseMode(const String& name, Mode& out) {
+    if (name == "auto") out = MODE_AUTO;
+    else if (name == "normal") out = MODE_NORMAL;
+    else if (name == "single") out = MODE_SINGLE;
+    else return false;
+    return true;
+  }
+
+  /** Seuil et hystérésis en codes natifs de l'IO source. */
+  void configure(Type type, int32_t level, int32_t hysteresis) {
+    _type = type;
+    _level = level;
+    if (hysteresis < 0) hysteresis = -hysteresis;
+    _below = level - hysteresis;
+    _above = level + hysteresis;
+    rearm();
+  }
+  /** Exige un nouveau passage du côté d'armement avant le prochain front. */
+  void rearm() { _ready = false; }
+  Type type() const { return _type; }
+
+  /** Teste un échantillon ; true s'il déclenche. */
+  bool test(int32_t code) {
+    switch (_type) {
+      case EDGE_RISING:
+        if (code < _below) {
+          _ready = true;
+          return false;
+        }
+        if (!_ready || code < _level) return false;
+        _ready = false;
+        return true;
+      case EDGE_FALLING:
+        if (code > _above) {
+          _ready = true;
+          return false;
+        }
+        if (!_ready || code > _level) return false;
+        _ready = false;
+        return true;
+      case LEVEL_HIGH:
+        return code >= _level;
+      case LEVEL_LOW:
+        return code <= _level;
+    }
+    return false;
+  }
+
+private:
+  Type _type = EDGE_RISING;
+  int32_t _level = 0;
+  int32_t _below = 0;   ///< Seuil d'armement d'un front montant
+  int32_t _above = 0;   ///< Seuil d'armement d'un front descendant
+  bool _ready = false;
+};
@@ -12,6 +12,10 @@ extern "C" {
 #include "core/ConfigStore.h"
 #include "core/Logger.h"
 #include "core/IORegistry.h"
+#include "core/Acquisition.h"
+#include "core/I2CManager.h"
+#include "core/SelfCal.h"
+#include "core/Trace.h"
 
 #include "ui/WebServer.h"
 #include "OledPin.h"
@@ -187,8 +191,8 @@ void refreshIoDisplay() {
   if (!g_oledInitialised) {
     return;
   }
-  auto ios = IORegistry::list();
-  OledPin::showIOValues(ios);
+  const auto& ios = IORegistry::list();
+  OledPin::showIOValues(ios, IORegistry::snapshot());
 }
 
 void updateServiceStatus() {
@@ -415,6 +419,7 @@ void setup() {
 
   setupAccessPointEventHandlers();
 
+  I2CManager::begin();
   OledPin::begin();
   g_oledInitialised = true;
   flushDeferredOledMessages();
@@ -425,6 +430,7 @@ void setup() {
   Logger::setLogCallback(handleLogLineForDisplay);
 
   IORegistry::begin();
+  Acquisition::begin();
 
   bool webStarted = WebServer::begin();
   g_webAvailable = webStarted && WebServer::isStarted();
@@ -443,6 +449,14 @@ void setup() {
 void loop() {
   unsigned long now = millis();
 
+  // L'acquisition est servie à chaque tour, hors de la cadence des
+  // périphériques, pour que l'échantillonnage ne dépende que de son
+  // propre ordonnanceur.
+  Acquisition::loop();
+  // Écritures I2C en file (DAC, blocs d'affichage) dans la limite du
+  // budget de bus, juste après l'acquisition.
+  I2CManager::loop();
+
   maintainAccessPoint();
   WebServer::loop();
   UDPServer::loop();
@@ -455,6 +469,8 @@ void loop() {
   if (now - g_lastPeripheralTick >= kPeripheralIntervalMs) {
     ConfigStore::loop();
     IORegistry::loop();
+    SelfCal::loop();
+    TraceRecorder::loop();
     DMM::loop();
     Scope::loop();
     FuncGen::loop();
@@ -0,0 +1,634 @@
+/**
+ * @file main.cpp
+ * @brief Programme hôte de l'environnement native (`pio run -e native`).
+ *
+ * Déroule la boucle principale de la carte sans WiFi, écran ni bus
+ * I2C réel, l'entrée A0 étant un SimA0 (sinus de 2 kHz) : ConfigStore et Logger sur un LittleFS adossé à un
+ * répertoire (native/data par défaut), IORegistry, moteur
+ * d'acquisition, multimètre, oscilloscope et générateur.  Le temps est
+ * virtuel et avance d'un pas fixe par tour, si bien que des minutes
+ * d'acquisition s'exécutent à la vitesse du processeur ; le programme
+ * affiche ensuite le rapport temps virtuel / temps réel et les
+ * statistiques JSON des modules, ainsi que le nombre et la taille des
+ * trames binaires que /ws/scope aurait diffusées, à comparer à la
+ * réponse JSON de l'oscilloscope.
+ *
+ * Les paquets de l'émetteur UDP sont captés au lieu d'être envoyés ;
+ * leur empreinte FNV-1a permet de comparer deux exécutions bit à bit,
+ * par exemple le rejeu d'une même trace avant et après une
+ * modification d'un filtre.
+ *
+ * Usage : program [-r racine] [-s secondes] [-p pas_us] [-q]
+ *                 [-t trace à rejouer] [-R trace à enregistrer]
+ *                 [-u fichier des paquets UDP] [-c sortie:entrée] [-b mesure] [-k]
+ * Avec -t et sans -s, l'exécution dure jusqu'à la fin de la trace.
+ * -c lance un auto-étalonnage par bouclage (options par défaut, sans
+ * sauvegarde) et en affiche le résultat.
+ * -k vérifie l'aller-retour de PackedCodes (suite vide, extrêmes i16,
+ * codes aléatoires, sinus et carré 10 bits, sinus 16 bits) et affiche
+ * la taille compactée, puis les ADS1115 simulés sur une seconde
+ * virtuelle : lectures en mode continu sans réécriture de la
+ * configuration, tourniquet équitable entre deux entrées single-shot et
+ * débit de chaque composant proche de son débit programmé ; code de
+ * sortie 1 au premier échec.
+ * -b lance une mesure de performance au lieu de la boucle, en temps du
+ * processeur hôte, sur les IO configurées sous la racine ("all" : toutes) :
+ * - fft : durée d'une transformée Q15 et d'un spectre complet (fenêtre,
+ *   dBFS, pics) pour chaque taille et chaque fenêtre ;
+ * - handles : accès à une IO par son nom avec copie de l'id, comme
+ *   avant les handles, puis par handle avec l'id en référence ;
+ * - codes : moyenne glissante et tampon d'échantillons en float
+ *   (conversion à chaque échantillon) puis en codes i16 (somme entière,
+ *   conversion à l'affichage), coût par échantillon et mémoire ;
+ * - dac : cadence de mise à jour du MCP4725 sur un bus simulé à
+ *   400 kHz (temps de bus seul) en commande registre de 3 octets, en
+ *   écriture rapide et en suites de mots rapides, puis écritures
+ *   évitées sur un code constant ;
+ * - ring : ajout d'un échantillon dans un tampon d'oscilloscope plein,
+ *   vecteur dont on efface le premier élément contre CaptureRing, pour
+ *   256, 1024 et 4096 échantillons.
+ * Les chemins de trace sont relatifs à la racine LittleFS.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "core/A0Burst.h"
+#include "core/Acquisition.h"
+#include "core/AdsScheduler.h"
+#include "core/CaptureRing.h"
+#include "core/ConfigStore.h"
+#include "core/IORegistry.h"
+#include "core/Logger.h"
+#include "core/Mcp4725.h"
+#include "core/PackedCodes.h"
+#include "core/SimI2C.h"
+#include "core/SelfCal.h"
+#include "core/Trace.h"
+#include "devices/DMM.h"
+#include "devices/FuncGen.h"
+#include "devices/Scope.h"
+#include "devices/ScopeSpectrum.h"
+#include "network/UDPServer.h"
+
+namespace {
+constexpr uint32_t kPeripheralIntervalUs = 5000;
+constexpr uint32_t kLoggerIntervalUs = 20000;
+
+// ADS1115 simulés, aux adresses des IO "ads1115" de native/data
+SimI2CBus g_bus;
+SimAds1115 g_ads48;
+SimAds1115 g_ads49;
+SimA0 g_a0;
+FILE* g_udpLog = nullptr;
+uint32_t g_udpHash = 2166136261u;
+uint32_t g_udpPackets = 0;
+
+// Tension vue par A0, 0,1 à 0,9 V : un sinus de 2 kHz, que seules les
+// rafales rapides (10 µs par échantillon) résolvent
+float a0Signal(uint32_t tUs) {
+  return 0.5f + 0.4f * sinf(2.0f * static_cast<float>(M_PI) * (tUs % 500) / 500.0f);
+}
+
+// Entrées des ADS1115 : sinus de 5 Hz sur 0x48, tensions fixes sur 0x49
+float ads48Signal(uint8_t channel, uint32_t tUs) {
+  (void)channel;
+  return 1.0f + 0.5f * sinf(2.0f * static_cast<float>(M_PI) * (tUs % 200000) / 200000.0f);
+}
+
+void onUdpPacket(const IPAddress&, uint16_t, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    g_udpHash = (g_udpHash ^ data[i]) * 16777619u;
+  }
+  g_udpPackets++;
+  if (g_udpLog) {
+    fwrite(data, 1, len, g_udpLog);
+    fputc('\n', g_udpLog);
+  }
+}
+
+void printJson(const char* title, JsonDocument& doc) {
+  std::string text;
+  serializeJson(doc, text);
+  printf("%s %s\n", title, text.c_str());
+}
+
+// Durée moyenne d'un appel, répété pendant au moins 100 ms
+template <typename F>
+double averageUs(F call) {
+  using Clock = std::chrono::steady_clock;
+  uint32_t runs = 0;
+  auto start = Clock::now();
+  Clock::duration elapsed{};
+  do {
+    call();
+    runs++;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(100));
+  return std::chrono::duration<double, std::micro>(elapsed).count() / runs;
+}
+
+void benchHandles() {
+  const std::vector<IOBase*>& list = IORegistry::list();
+  if (list.empty()) {
+    printf("handles: no IO configured\n");
+    return;
+  }
+  std::vector<String> ids;
+  std::vector<IOHandle> handles;
+  for (IOBase* io : list) {
+    ids.push_back(io->id());
+    handles.push_back(IORegistry::resolve(io->id()));
+  }
+  const uint32_t rounds = 1000;
+  volatile size_t sink = 0;
+  double byName = averageUs([&]() {
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (const String& id : ids) {
+        String copy = IORegistry::get(id)->id();
+        sink = sink + copy.length();
+      }
+    }
+  });
+  double byHandle = averageUs([&]() {
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (IOHandle handle : handles) {
+        const String& id = IORegistry::at(handle)->id();
+        sink = sink + id.length();
+      }
+    }
+  });
+  double accesses = static_cast<double>(rounds) * ids.size();
+  printf("handles %u IOs: by name + id copy %.1f ns, by handle + id reference %.1f ns (x%.1f)\n",
+         static_cast<unsigned>(ids.size()), byName * 1000.0 / accesses,
+         byHandle * 1000.0 / accesses, byHandle > 0 ? byName / byHandle : 0.0);
+}
+
+void benchCodes() {
+  IOBase* io = IORegistry::list().empty() ? nullptr : IORegistry::list()[0];
+  if (!io) {
+    printf("codes: no IO configured\n");
+    return;
+  }
+  // Fenêtre de moyenne du multimètre et tampon de l'oscilloscope
+  const size_t window = 256;
+  std::vector<int16_t> codes(4096);
+  for (size_t i = 0; i < codes.size(); ++i) {
+    codes[i] = static_cast<int16_t>(lround(16000.0 * sin(2.0 * M_PI * i / 97.0)));
+  }
+  volatile float sink = 0.0f;
+  std::vector<float> floats(window, 0.0f);
+  float floatSum = 0.0f;
+  double floatUs = averageUs([&]() {
+    // Ancien chemin : normalisation puis vref × ratio à chaque échantillon
+    for (size_t i = 0; i < codes.size(); ++i) {
+      float v = codes[i] * io->rawScale() * io->getVref() * io->getRatio();
+      float& slot = floats[i & (window - 1)];
+      floatSum += v - slot;
+      slot = v;
+    }
+    sink = floatSum / window;
+  });
+  std::vector<int16_t> ints(window, 0);
+  int32_t intSum = 0;
+  double intUs = averageUs([&]() {
+    for (size_t i = 0; i < codes.size(); ++i) {
+      int16_t& slot = ints[i & (window - 1)];
+      intSum += codes[i] - slot;
+      slot = codes[i];
+    }
+    // Une seule conversion, à la présentation
+    sink = intSum * io->scale() / window;
+  });
+  printf("codes %s: float %.2f ns/sample, %u B/window; int16 %.2f ns/sample, %u B/window\n",
+         io->id().c_str(), floatUs * 1000.0 / codes.size(),
+         static_cast<unsigned>(window * sizeof(float)), intUs * 1000.0 / codes.size(),
+         static_cast<unsigned>(window * sizeof(int16_t)));
+}
+
+void benchDac() {
+  // Bus privé : celui du programme reste sans composant
+  SimI2CBus bus;
+  SimMcp4725 chip;
+  const uint8_t address = 0x60;
+  bus.attach(address, &chip);
+  bus.setClock(400000);
+  I2CBus* previous = &I2CBus::active();
+  I2CBus::setActive(&bus);
+  std::vector<uint16_t> sine(4096);
+  for (size_t i = 0; i < sine.size(); ++i) {
+    sine[i] = static_cast<uint16_t>(lround(2047.5 + 2047.5 * sin(2.0 * M_PI * i / sine.size())));
+  }
+  auto report = [&](const char* mode, uint32_t updates) {
+    printf("dac %-16s %6u updates, %5u transactions, %7.1f k updates/s\n", mode, updates,
+           bus.transactions(), bus.busyUs() ? updates * 1000.0 / bus.busyUs() : 0.0);
+    bus.resetCounters();
+  };
+  for (uint16_t code : sine) {
+    // Commande « write DAC register » de l'ancien pilote Adafruit
+    uint8_t buf[3] = {0x40, static_cast<uint8_t>(code >> 4), static_cast<uint8_t>(code << 4)};
+    bus.write(address, buf, sizeof(buf));
+  }
+  report("register 3 B", sine.size());
+  Mcp4725 fast(address);
+  fast.begin();
+  bus.resetCounters();
+  for (uint16_t code : sine) fast.write(code);
+  report("fast 2 B", sine.size());
+  Mcp4725 stream(address);
+  stream.begin();
+  bus.resetCounters();
+  report("stream x16", stream.writeStream(sine.data(), sine.size()));
+  Mcp4725 flat(address);
+  flat.begin();
+  bus.resetCounters();
+  for (int i = 0; i < 2000; ++i) flat.write(1234);
+  printf("dac %-16s %6u updates, %5u transactions, %u skipped\n", "constant code", 2000u,
+         bus.transactions(), flat.skipped());
+  I2CBus::setActive(previous);
+}
+
+void benchRing() {
+  const size_t pushes = 1 << 16;
+  for (size_t size : {256u, 1024u, 4096u}) {
+    volatile int16_t sink = 0;
+    // Ancien stockage des canaux : le plus ancien effacé à chaque ajout
+    std::vector<int16_t> vec(size, 0);
+    int16_t code = 0;
+    double eraseUs = averageUs([&]() {
+      for (size_t i = 0; i < pushes; ++i) {
+        vec.erase(vec.begin());
+        vec.push_back(code++);
+      }
+      sink = vec.front();
+    });
+    CaptureRing<int16_t> ring;
+    ring.allocate(size);
+    double ringUs = averageUs([&]() {
+      for (size_t i = 0; i < pushes; ++i) ring.push(code++);
+      sink = ring.view().at(0);
+    });
+    printf("ring %4u samples: vector erase %.2f ns/sample, ring %.2f ns/sample\n",
+           static_cast<unsigned>(size), eraseUs * 1000.0 / pushes, ringUs * 1000.0 / pushes);
+  }
+}
+
+void benchFft() {
+  const FixedFft::Window windows[] = {FixedFft::WINDOW_HANN, FixedFft::WINDOW_FLATTOP,
+                                      FixedFft::WINDOW_BLACKMAN_HARRIS};
+  // Deux sinusoïdes sur un convertisseur 16 bits échantillonné à 10 kHz
+  std::vector<int16_t> codes(FixedFft::MAX_SIZE);
+  for (size_t i = 0; i < codes.size(); ++i) {
+    codes[i] = static_cast<int16_t>(lround(24000.0 * sin(2.0 * M_PI * 1234.5 * i / 10000.0) +
+                                           2400.0 * sin(2.0 * M_PI * 3000.0 * i / 10000.0)));
+  }
+  std::vector<int16_t> re(FixedFft::MAX_SIZE);
+  std::vector<int16_t> im(FixedFft::MAX_SIZE);
+  for (uint16_t size = FixedFft::MIN_SIZE; size <= FixedFft::MAX_SIZE; size <<= 1) {
+    double transformUs = averageUs([&]() {
+      std::copy(codes.begin(), codes.begin() + size, re.begin());
+      std::fill(im.begin(), im.begin() + size, 0);
+      FixedFft::transform(re.data(), im.data(), size);
+    });
+    printf("fft %4u points: transform %.2f us", size, transformUs);
+    for (FixedFft::Window window : windows) {
+      ScopeSpectrum spectrum;
+      spectrum.configure(size, window, 5);
+      double spectrumUs = averageUs([&]() {
+        spectrum.compute(codes.data(), size, -32768, 32767, 100.0f);
+      });
+      printf(", %s %.2f us", FixedFft::windowName(window), spectrumUs);
+    }
+    printf("\n");
+  }
+}
+struct Bench {
+  const char* name;
+  void (*run)();
+};
+const Bench kBenches[] = {
+  {"fft", benchFft},
+  {"handles", benchHandles},
+  {"codes", benchCodes},
+  {"dac", benchDac},
+  {"ring", benchRing},
+};
+
+/** Compacte puis décode `codes` ; false si un code diffère. */
+bool checkPacked(const char* name, const std::vector<int16_t>& codes) {
+  PackedCodes packed;
+  packed.pack(codes.data(), codes.size());
+  std::vector<int16_t> back(codes.size());
+  packed.unpack(back.data());
+  bool ok = packed.count() == codes.size() && back == codes;
+  printf("packed %-14s %6u codes, %7u bytes, %.2f B/sample, %s\n", name,
+         static_cast<unsigned>(codes.size()), static_cast<unsigned>(packed.bytes()),
+         codes.empty() ? 0.0 : static_cast<double>(packed.bytes()) / codes.size(),
+         ok ? "ok" : "MISMATCH");
+  return ok;
+}
+
+/** Aller-retour de PackedCodes sur des suites choisies ; false au premier écart. */
+bool checkPackedCodes() {
+  bool ok = checkPacked("empty", {});
+  ok = checkPacked("extremes", {32767, -32768, 32767, -32768, 0, -1, 1, -32768, -32768, 32767}) && ok;
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> any(-32768, 32767);
+  std::normal_distribution<double> noise(0.0, 2.0);
+  std::vector<int16_t> codes(100000);
+  for (int16_t& code : codes) code = static_cast<int16_t>(any(rng));
+  ok = checkPacked("random", codes) && ok;
+  // Formes d'onde d'un convertisseur 10 bits puis 16 bits
+  auto wave = [&](const char* name, double amplitude, double period, bool square, bool noisy) {
+    std::vector<int16_t> w(4096);
+    for (size_t i = 0; i < w.size(); ++i) {
+      double s = sin(2.0 * M_PI * i / period);
+      double v = amplitude * (square ? (s >= 0.0 ? 1.0 : -1.0) : s) + (noisy ? noise(rng) : 0.0);
+      w[i] = static_cast<int16_t>(lround(std::max(-32768.0, std::min(32767.0, v))));
+    }
+    return checkPacked(name, w);
+  };
+  ok = wave("sine10 /80", 511.0, 80.0, false, false) && ok;
+  ok = wave("sine10 /20", 511.0, 20.0, false, false) && ok;
+  ok = wave("sine10+noise", 511.0, 80.0, false, true) && ok;
+  ok = wave("square10", 511.0, 80.0, true, false) && ok;
+  ok = wave("sine16 /512", 32767.0, 512.0, false, false) && ok;
+  return ok;
+}
+
+/** Affiche une vérification et la retourne. */
+bool report(const char* what, bool ok) {
+  printf("ads %-46s %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+/**
+ * Deux ADS1115 simulés à 860 SPS sur un bus privé : 0x48 en continu sur
+ * une entrée, 0x49 en single-shot sur deux entrées en tourniquet.  Le
+ * moteur d'acquisition est imité : demande sur chaque emplacement puis
+ * service des deux composants, toutes les 100 µs de temps virtuel.
+ */
+bool checkAds() {
+  SimI2CBus bus;
+  SimAds1115 chipA;
+  SimAds1115 chipB;
+  chipA.setInput(0, 1.0f);
+  chipB.setInput(0, 0.5f);
+  chipB.setInput(1, 1.5f);
+  bus.attach(0x48, &chipA);
+  bus.attach(0x49, &chipB);
+  I2CBus* previous = &I2CBus::active();
+  I2CBus::setActive(&bus);
+  AdsScheduler a(new Ads1115(0x48));
+  AdsScheduler b(new Ads1115(0x49));
+  bool ok = report("both chips answer", a.device()->begin() && b.device()->begin());
+  a.device()->setDataRate(860);
+  b.device()->setDataRate(860);
+  const int slots[3] = {a.addChannel(0, 4.096f, true), b.addChannel(0, 4.096f, false),
+                        b.addChannel(1, 4.096f, false)};
+  AdsScheduler* owners[3] = {&a, &b, &b};
+  // Code attendu : tension / 4,096 V × 32768, à un code près (arrondi)
+  const int16_t expected[3] = {8000, 4000, 12000};
+  uint32_t counts[3] = {0, 0, 0};
+  bool codesOk = true;
+  for (uint32_t t = 0; t < 1000000; t += 100) {
+    for (int k = 0; k < 3; ++k) owners[k]->request(slots[k]);
+    a.service();
+    b.service();
+    for (int k = 0; k < 3; ++k) {
+      int16_t code;
+      bool read;
+      if (!owners[k]->take(slots[k], code, read)) continue;
+      counts[k]++;
+      if (!read || abs(code - expected[k]) > 1) codesOk = false;
+    }
+    NativeClock::advanceUs(100);
+  }
+  I2CBus::setActive(previous);
+  char line[96];
+  ok = report("every read returns the input code", codesOk) && ok;
+  snprintf(line, sizeof(line), "continuous 0x48: %u reads, %u config writes", counts[0],
+           chipA.configWrites());
+  ok = report(line, chipA.configWrites() == 1 && a.device()->configSkipped() + 1 >= counts[0]) && ok;
+  snprintf(line, sizeof(line), "continuous 0x48: %u SPS of 860", counts[0]);
+  ok = report(line, counts[0] >= 860 * 9 / 10) && ok;
+  snprintf(line, sizeof(line), "round-robin 0x49: %u + %u reads", counts[1], counts[2]);
+  ok = report(line, counts[1] > 0 && (counts[1] > counts[2] ? counts[1] - counts[2] : counts[2] - counts[1]) <= 1) && ok;
+  snprintf(line, sizeof(line), "single-shot 0x49: %u SPS of 860", counts[1] + counts[2]);
+  ok = report(line, counts[1] + counts[2] >= 860 * 7 / 10) && ok;
+  return ok;
+}
+
+/** Lance la mesure `name` ou toutes ("all") ; false si le nom est inconnu. */
+bool runBench(const std::string& name) {
+  bool found = false;
+  for (const Bench& bench : kBenches) {
+    if (name != "all" && name != bench.name) continue;
+    bench.run();
+    found = true;
+  }
+  return found;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* root = "native/data";
+  double seconds = -1.0;
+  uint32_t stepUs = 100;
+  const char* replayPath = nullptr;
+  const char* recordPath = nullptr;
+  std::string selfCal;
+  std::string bench;
+  bool check = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:s:p:qt:R:u:c:b:k")) != -1) {
+    switch (opt) {
+      case 'r': root = optarg; break;
+      case 's': seconds = atof(optarg); break;
+      case 'p': stepUs = static_cast<uint32_t>(atoi(optarg)); break;
+      case 'q': Serial.setQuiet(true); break;
+      case 't': replayPath = optarg; break;
+      case 'R': recordPath = optarg; break;
+      case 'c': selfCal = optarg; break;
+      case 'b': bench = optarg; break;
+      case 'k': check = true; break;
+      case 'u':
+        g_udpLog = fopen(optarg, "w");
+        if (!g_udpLog) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-r root] [-s seconds] [-p step_us] [-q] "
+                        "[-t replay] [-R record] [-u udp_log] [-c output:input] [-b bench] [-k]\n", argv[0]);
+        return 2;
+    }
+  }
+  // Vérifications sans configuration ni équipement
+  if (check) {
+    bool ok = checkPackedCodes();
+    ok = checkAds() && ok;
+    return ok ? 0 : 1;
+  }
+  if (stepUs == 0) stepUs = 1;
+  if (seconds < 0) seconds = replayPath ? 1e9 : 10.0;
+
+  LittleFS.setRoot(root);
+  g_ads48.setSignal(ads48Signal);
+  g_ads49.setInput(0, 0.5f);
+  g_ads49.setInput(1, 1.5f);
+  g_bus.attach(0x48, &g_ads48);
+  g_bus.attach(0x49, &g_ads49);
+  I2CBus::setActive(&g_bus);
+  g_a0.setSignal(a0Signal);
+  A0Adc::setActive(&g_a0);
+  WiFiUDP::setSink(onUdpPacket);
+  ConfigStore::begin();
+  Logger::begin();
+  if (replayPath) {
+    // Le rejeu remplace tous les équipements configurés (non sauvegardé)
+    JsonArray devices = ConfigStore::doc("io")["devices"].to<JsonArray>();
+    JsonObject dev = devices.add<JsonObject>();
+    dev["id"] = "replay";
+    dev["driver"] = "replay";
+    dev["trace"] = replayPath;
+  }
+  IORegistry::begin();
+  if (!bench.empty()) {
+    if (runBench(bench)) return 0;
+    fprintf(stderr, "unknown bench %s\n", bench.c_str());
+    return 2;
+  }
+  Acquisition::begin();
+  DMM::begin();
+  Scope::begin();
+  FuncGen::begin();
+  UDPServer::begin();
+  if (recordPath && !TraceRecorder::start(recordPath)) return 1;
+  if (!selfCal.empty()) {
+    size_t colon = selfCal.find(':');
+    JsonDocument options;
+    options["save"] = false;
+    String error;
+    if (colon == std::string::npos ||
+        !SelfCal::start(selfCal.substr(0, colon).c_str(), selfCal.substr(colon + 1).c_str(),
+                        options.as<JsonVariantConst>(), error)) {
+      fprintf(stderr, "self-calibration: %s\n", colon == std::string::npos ? "expected output:input" : error.c_str());
+      return 1;
+    }
+  }
+
+  uint64_t totalUs = static_cast<uint64_t>(seconds * 1e6);
+  uint64_t elapsedUs = 0;
+  uint32_t lastPeripheral = micros();
+  uint32_t lastLogger = micros();
+  uint64_t iterations = 0;
+  uint32_t frameSeq = Scope::frameSeq();
+  uint32_t frames = 0;
+  uint32_t spectrumSeq = Scope::spectrumSeq();
+  uint32_t spectra = 0;
+  std::vector<uint8_t> frame;
+  std::chrono::steady_clock::duration encodeTime{};
+  auto wallStart = std::chrono::steady_clock::now();
+  while (elapsedUs < totalUs && !TracePlayer::finished()) {
+    NativeClock::advanceUs(stepUs);
+    elapsedUs += stepUs;
+    iterations++;
+    uint32_t now = micros();
+    Acquisition::loop();
+    UDPServer::loop();
+    if (now - lastLogger >= kLoggerIntervalUs) {
+      Logger::loop();
+      lastLogger = now;
+    }
+    if (now - lastPeripheral >= kPeripheralIntervalUs) {
+      ConfigStore::loop();
+      IORegistry::loop();
+      SelfCal::loop();
+      TraceRecorder::loop();
+      DMM::loop();
+      Scope::loop();
+      if (Scope::frameSeq() != frameSeq) {
+        // Même encodage que WebServer::loop() pour chaque nouvelle capture
+        frameSeq = Scope::frameSeq();
+        auto t0 = std::chrono::steady_clock::now();
+        Scope::encodeFrame(frame);
+        encodeTime += std::chrono::steady_clock::now() - t0;
+        frames++;
+      }
+      if (Scope::spectrumSeq() != spectrumSeq) {
+        spectrumSeq = Scope::spectrumSeq();
+        spectra++;
+      }
+      FuncGen::loop();
+      lastPeripheral = now;
+    }
+  }
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  TraceRecorder::stop();
+  if (g_udpLog) fclose(g_udpLog);
+
+  printf("virtual %.3f s, wall %.3f s, x%.1f, %.0f loops/s\n",
+         elapsedUs / 1e6, wallS, wallS > 0 ? elapsedUs / 1e6 / wallS : 0.0,
+         wallS > 0 ? iterations / wallS : 0.0);
+  printf("udp %u packets, fnv1a %08x\n", g_udpPackets, g_udpHash);
+  JsonDocument acq;
+  JsonObject acqObj = acq.to<JsonObject>();
+  Acquisition::stats(acqObj);
+  printJson("acq", acq);
+  JsonDocument dmm;
+  JsonObject dmmObj = dmm.to<JsonObject>();
+  DMM::values(dmmObj);
+  printJson("dmm", dmm);
+  JsonDocument scope;
+  JsonObject scopeObj = scope.to<JsonObject>();
+  Scope::toJson(scopeObj);
+  printJson("scope", scope);
+  std::string scopeText;
+  serializeJson(scope, scopeText);
+  Scope::encodeFrame(frame);
+  printf("scope frames %u (%.1f/s), %u bytes/frame vs %u bytes JSON, encode %.2f us\n",
+         frames, elapsedUs > 0 ? frames * 1e6 / elapsedUs : 0.0,
+         static_cast<unsigned>(frame.size()), static_cast<unsigned>(scopeText.size()),
+         frames ? std::chrono::duration<double, std::micro>(encodeTime).count() / frames : 0.0);
+  JsonDocument spectrum;
+  JsonObject spectrumObj = spectrum.to<JsonObject>();
+  if (Scope::spectrumToJson(spectrumObj)) {
+    Scope::encodeSpectrum(frame);
+    JsonObject peak = spectrumObj["peaks"][0];
+    printf("scope spectra %u, %u points, %.2f Hz/bin, peak %.2f Hz %.2f dBFS, "
+           "compute %u us, %u bytes/frame\n",
+           spectra, spectrumObj["points"].as<unsigned>(), spectrumObj["bin_hz"].as<double>(),
+           peak["hz"] | 0.0, peak["dbfs"] | 0.0, spectrumObj["compute_us"].as<unsigned>(),
+           static_cast<unsigned>(frame.size()));
+  }
+  if (g_a0.fastBursts() || g_a0.reads()) {
+    printf("a0 fast bursts %u, paced reads %u\n", g_a0.fastBursts(), g_a0.reads());
+  }
+  Scope::encodeSegments(frame);
+  if (!frame.empty()) {
+    JsonObject segments = scopeObj["trigger"]["segments"];
+    printf("scope segments %u x %u samples, missed %u, rearm %u us, %u bytes\n",
+           segments["count"].as<unsigned>(), segments["length"].as<unsigned>(),
+           segments["missed"].as<unsigned>(), segments["rearm_us"].as<unsigned>(),
+           static_cast<unsigned>(frame.size()));
+  }
+  if (!selfCal.empty()) {
+    JsonDocument cal;
+    JsonObject calObj = cal.to<JsonObject>();
+    SelfCal::status(calObj);
+    printJson("selfcal", cal);
+  }
+  return 0;
+}
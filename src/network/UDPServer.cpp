@@ -6,6 +6,7 @@
 #include "UDPServer.h"
 #include "core/ConfigStore.h"
 #include "core/Logger.h"
+#include "core/IORegistry.h"
 #include "devices/DMM.h"
 #include "devices/FuncGen.h"
 
@@ -66,6 +67,7 @@ namespace {
    * {
    *   "type": "dmm",
    *   "ts": <timestamp_ms>,
+   *   "gen": <gÃ©nÃ©ration de l'instantanÃ© IORegistry>,
    *   "values": { "CH1": "1.234", ... }
    * }
    */
@@ -73,9 +75,9 @@ namespace {
     DynamicJsonDocument doc(512);
     doc["type"] = "dmm";
     doc["ts"] = millis();
+    doc["gen"] = IORegistry::snapshot().generation;
     JsonObject vals = doc["values"].to<JsonObject>();
-    // Mise Ã  jour des valeurs avant Ã©mission
-    DMM::loop();
+    // Les valeurs sont tenues Ã  jour par DMM::loop() dans la boucle principale
     DMM::values(vals);
     String json;
     serializeJson(doc, json);
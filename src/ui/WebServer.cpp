@@ -7,6 +7,10 @@
 #include "core/ConfigStore.h"
 #include "core/Logger.h"
 #include "core/IORegistry.h"
+#include "core/Acquisition.h"
+#include "core/I2CManager.h"
+#include "core/SelfCal.h"
+#include "core/Trace.h"
 #include "OledPin.h"
 #include "devices/DMM.h"
 #include "devices/Scope.h"
@@ -90,6 +94,7 @@ constexpr const char kDefaultIndexHtml[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       <div class="card" id="cardScope">
         <h3>Oscilloscope</h3>
         <canvas id="scopeCanvas" width="300" height="150" style="background:#f1f5f9;border:1px solid #cbd5e1;border-radius:0.5rem;"></canvas>
+        <div id="scopeMeasures" style="font-size:0.8rem;"></div>
         <p>En développement...</p>
       </div>
       <div class="card" id="cardFunc">
@@ -451,10 +456,68 @@ constexpr const char kDefaultIndexHtml[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       ws.onclose = () => { ws = null; };
     }
 
+    let scopeWs;
+
+    // Trames binaires de /ws/scope (format décrit dans Scope.h)
+    function startScope() {
+      if (scopeWs) {
+        return;
+      }
+      scopeWs = new WebSocket('ws://'+window.location.host+'/ws/scope');
+      scopeWs.binaryType = 'arraybuffer';
+      scopeWs.onmessage = (evt) => drawScopeFrame(new DataView(evt.data));
+      scopeWs.onclose = () => { scopeWs = null; };
+    }
+
+    function drawScopeFrame(view) {
+      // Trames "MLSF" seulement : les spectres ("MLSP") partagent la socket
+      if (view.byteLength < 16 || view.getUint32(0, true) !== 0x46534C4D || view.getUint8(4) !== 2) {
+        return;
+      }
+      const count = view.getUint8(5);
+      const channels = [];
+      let pos = 16;
+      for (let k = 0; k < count; k++) {
+        const ch = {
+          count: view.getUint16(pos, true),
+          gain: view.getFloat32(pos + 4, true),
+          shift: view.getFloat32(pos + 8, true),
+          vpp: view.getFloat32(pos + 24, true),
+          rms: view.getFloat32(pos + 32, true),
+          freq: view.getFloat32(pos + 36, true)
+        };
+        const len = view.getUint8(pos + 56);
+        ch.name = String.fromCharCode(...new Uint8Array(view.buffer, pos + 57, len));
+        pos += 57 + len;
+        channels.push(ch);
+      }
+      // Mesures calculées par la carte : aucun calcul sur les échantillons
+      document.getElementById('scopeMeasures').textContent = channels.map(ch =>
+        ch.name + ' : Vpp ' + ch.vpp.toFixed(3) + ' V, RMS ' + ch.rms.toFixed(3) + ' V' +
+        (isNaN(ch.freq) ? '' : ', ' + ch.freq.toFixed(1) + ' Hz')).join(' | ');
+      pos += pos & 1;
+      const canvas = document.getElementById('scopeCanvas');
+      const ctx = canvas.getContext('2d');
+      ctx.clearRect(0, 0, canvas.width, canvas.height);
+      const colors = ['#2563eb', '#dc2626', '#16a34a', '#d97706'];
+      channels.forEach((ch, k) => {
+        ctx.strokeStyle = colors[k % colors.length];
+        ctx.beginPath();
+        for (let i = 0; i < ch.count; i++, pos += 2) {
+          const v = view.getInt16(pos, true) * ch.gain + ch.shift;
+          const x = ch.count > 1 ? i * canvas.width / (ch.count - 1) : 0;
+          const y = canvas.height / 2 - v * canvas.height / 8;
+          if (i === 0) ctx.moveTo(x, y); else ctx.lineTo(x, y);
+        }
+        ctx.stroke();
+      });
+    }
+
     setInterval(() => {
       if (document.getElementById('dashboard').style.display === 'block') {
         loadIO();
         loadDmmChannels();
+        startScope();
       }
     }, 2000);
   </script>
@@ -603,12 +666,34 @@ void ensureIndexHtmlPresent() {
 AsyncWebServer WebServer::_server(80);
 AsyncWebSocket WebServer::_wsLogs("/ws/logs");
 AsyncWebSocket WebServer::_wsUi("/ws/ui");
+AsyncWebSocket WebServer::_wsScope("/ws/scope");
 int WebServer::_logClients = 0;
 int WebServer::_uiClients = 0;
 bool WebServer::_started = false;
 bool WebServer::_hasAuthenticatedClient = false;
 String WebServer::_expectedPin;
 
+namespace {
+// Comparaison des deux chemins de l'oscilloscope : trames binaires
+// diffusées sur /ws/scope et réponses JSON de /api/scope
+struct ScopeStreamStats {
+  uint32_t lastSeq = 0;
+  uint32_t lastSpectrumSeq = 0;
+  uint32_t spectra = 0;      ///< Trames de spectre envoyées
+  uint32_t frames = 0;
+  uint32_t dropped = 0;      ///< Captures non envoyées (file d'un client pleine)
+  uint32_t bytes = 0;        ///< Taille de la dernière trame
+  uint32_t encodeUs = 0;
+  uint32_t windowMs = 0;
+  uint32_t windowFrames = 0;
+  float fps = 0.0f;
+  uint32_t jsonRequests = 0;
+  uint32_t jsonBytes = 0;
+  uint32_t jsonBuildUs = 0;
+};
+ScopeStreamStats scopeStream;
+}  // namespace
+
 bool WebServer::begin() {
   ensureIndexHtmlPresent();
   _started = false;
@@ -727,6 +812,18 @@ bool WebServer::begin() {
   });
   _server.addHandler(&_wsUi);
 
+  // Flux binaire de l'oscilloscope : une trame par capture, partagée
+  // par tous les clients (voir Scope::encodeFrame())
+  _wsScope.onEvent([](AsyncWebSocket *server, AsyncWebSocketClient *client,
+                      AwsEventType type, void *arg, uint8_t *data, size_t len) {
+    if (type == WS_EVT_CONNECT) {
+      Logger::info("WS", "scope_connect", String("Client scope connected: ") + server->count());
+    } else if (type == WS_EVT_DISCONNECT) {
+      Logger::info("WS", "scope_disconnect", String("Client scope disconnected: ") + server->count());
+    }
+  });
+  _server.addHandler(&_wsScope);
+
   // Gestion du corps des requêtes JSON (collecte dans request->_tempObject)
   _server.onRequestBody([](AsyncWebServerRequest *request, uint8_t *data,
                            size_t len, size_t index, size_t total) {
@@ -864,11 +961,17 @@ bool WebServer::begin() {
     }
     StaticJsonDocument<1024> doc;
     JsonArray arr = doc.to<JsonArray>();
-    auto list = IORegistry::list();
-    for (auto io : list) {
+    // Lecture de l'instantané publié par l'acquisition : aucune
+    // transaction I2C n'est faite depuis le gestionnaire asynchrone.
+    const auto &list = IORegistry::list();
+    const IOSnapshot &snap = IORegistry::snapshot();
+    for (size_t i = 0; i < list.size() && i < snap.codes.size(); ++i) {
       JsonObject obj = arr.add<JsonObject>();
-      obj["id"] = io->id();
-      obj["raw"] = io->readRaw();
+      obj["id"] = list[i]->id();
+      obj["raw"] = snap.codes[i] * list[i]->rawScale();
+      obj["code"] = snap.codes[i];
+      obj["ts"] = snap.stamps[i];
+      obj["gen"] = snap.generation;
     }
     String out;
     serializeJson(doc, out);
@@ -881,8 +984,7 @@ bool WebServer::begin() {
       request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
       return;
     }
-    DMM::loop(); // mise ÃƒÂ  jour rapide
-    StaticJsonDocument<256> doc;
+    JsonDocument doc;
     JsonObject obj = doc.to<JsonObject>();
     DMM::values(obj);
     String out;
@@ -890,22 +992,233 @@ bool WebServer::begin() {
     request->send(200, "application/json", out);
   });
 
+  // Route GET /api/scope/stats : cadence et taille des trames binaires
+  // comparées aux réponses JSON.  Déclarée avant /api/scope, dont le
+  // gestionnaire accepte aussi les sous-chemins
+  _server.on("/api/scope/stats", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    scopeStats(obj);
+    String out;
+    serializeJson(doc, out);
+    request->send(200, "application/json", out);
+  });
+
+  // Route GET /api/scope/envelope?channel=&start=&count=&width= :
+  // enveloppe min/max d'une fenêtre de la dernière capture, d'une
+  // taille fixée par la largeur d'affichage
+  _server.on("/api/scope/envelope", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    if (!request->hasParam("channel")) {
+      request->send(400, "application/json", "{\"error\":\"channel required\"}");
+      return;
+    }
+    String channel = request->getParam("channel")->value();
+    uint32_t start = request->hasParam("start") ? request->getParam("start")->value().toInt() : 0;
+    uint32_t count = request->hasParam("count") ? request->getParam("count")->value().toInt() : 0;
+    long width = request->hasParam("width") ? request->getParam("width")->value().toInt() : 300;
+    if (width < 0 || width > Scope::MAX_ENVELOPE_WIDTH) width = 0;
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    String error;
+    if (!Scope::envelope(channel, start, count, static_cast<uint16_t>(width), obj, error)) {
+      JsonDocument res;
+      res["error"] = error;
+      String out;
+      serializeJson(res, out);
+      request->send(400, "application/json", out);
+      return;
+    }
+    String out;
+    serializeJson(doc, out);
+    request->send(200, "application/json", out);
+  });
+
+  // Route GET /api/scope/segments : dernière séquence de l'acquisition
+  // segmentée, en un bloc binaire (format décrit dans Scope.h)
+  _server.on("/api/scope/segments", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    auto blob = std::make_shared<std::vector<uint8_t>>();
+    Scope::encodeSegments(*blob);
+    if (blob->empty()) {
+      request->send(404, "application/json", "{\"error\":\"no segmented capture\"}");
+      return;
+    }
+    // Le bloc vit jusqu'au dernier envoi : la réponse est asynchrone
+    request->send("application/octet-stream", blob->size(),
+                  [blob](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+      size_t n = blob->size() - index;
+      if (n > maxLen) n = maxLen;
+      memcpy(buffer, blob->data() + index, n);
+      return n;
+    });
+  });
+
+  // Route GET /api/scope/spectrum : dernier spectre (dBFS) et ses pics
+  _server.on("/api/scope/spectrum", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    if (!Scope::spectrumToJson(obj)) {
+      request->send(404, "application/json", "{\"error\":\"spectrum disabled\"}");
+      return;
+    }
+    String out;
+    serializeJson(doc, out);
+    request->send(200, "application/json", out);
+  });
+
   // Route GET /api/scope
   _server.on("/api/scope", HTTP_GET, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) {
       request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
       return;
     }
-    // Mise ÃƒÂ  jour de l'oscilloscope
-    Scope::loop();
-    StaticJsonDocument<1024> doc;
+    uint32_t t0 = micros();
+    JsonDocument doc;
     JsonObject obj = doc.to<JsonObject>();
     Scope::toJson(obj);
     String out;
     serializeJson(doc, out);
+    scopeStream.jsonBuildUs = micros() - t0;
+    scopeStream.jsonBytes = out.length();
+    scopeStream.jsonRequests++;
+    request->send(200, "application/json", out);
+  });
+
+  // Route POST /api/scope/arm : réarme le déclenchement (mode single)
+  _server.on("/api/scope/arm", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    Scope::arm();
+    request->send(200, "application/json", "{\"success\":true}");
+  });
+
+  // Route GET /api/acq : cadence effective, pertes par canal, pilotes
+  // et compteurs du bus I2C
+  _server.on("/api/acq", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    Acquisition::stats(obj);
+    JsonObject drivers = obj["drivers"].to<JsonObject>();
+    IORegistry::driverStats(drivers);
+    JsonObject i2c = obj["i2c"].to<JsonObject>();
+    I2CManager::stats(i2c);
+    String out;
+    serializeJson(doc, out);
+    request->send(200, "application/json", out);
+  });
+
+  // Route GET /api/trace : état de l'enregistrement ou du rejeu
+  _server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    TraceRecorder::stats(obj);
+    String out;
+    serializeJson(doc, out);
     request->send(200, "application/json", out);
   });
 
+  // Route POST /api/trace : {"action":"start","path":"/traces/x.bin"}
+  // ou {"action":"stop"}
+  _server.on("/api/trace", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    String body = readRequestBody(request);
+    JsonDocument doc;
+    if (!body.length() || deserializeJson(doc, body)) {
+      request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+      return;
+    }
+    String action = doc["action"] | "";
+    if (action == "start") {
+      String path = doc["path"] | "/traces/capture.bin";
+      if (!TraceRecorder::start(path)) {
+        request->send(500, "application/json", "{\"error\":\"Cannot create trace\"}");
+        return;
+      }
+    } else if (action == "stop") {
+      TraceRecorder::stop();
+    } else {
+      request->send(400, "application/json", "{\"error\":\"Unknown action\"}");
+      return;
+    }
+    request->send(200, "application/json", "{\"success\":true}");
+  });
+
+  // Route GET /api/selfcal : état et résultat de l'auto-étalonnage
+  _server.on("/api/selfcal", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    JsonDocument doc;
+    JsonObject obj = doc.to<JsonObject>();
+    SelfCal::status(obj);
+    String out;
+    serializeJson(doc, out);
+    request->send(200, "application/json", out);
+  });
+
+  // Route POST /api/selfcal : {"action":"start","output":"DAC1",
+  // "input":"ADS1","points":33,"averages":4,"settle_us":2000,
+  // "reference":"input","save":true} ou {"action":"abort"}
+  _server.on("/api/selfcal", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) {
+      request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+      return;
+    }
+    String body = readRequestBody(request);
+    JsonDocument doc;
+    if (!body.length() || deserializeJson(doc, body)) {
+      request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+      return;
+    }
+    String action = doc["action"] | "";
+    if (action == "start") {
+      String error;
+      if (!SelfCal::start(doc["output"] | "", doc["input"] | "", doc.as<JsonVariantConst>(), error)) {
+        JsonDocument res;
+        res["error"] = error;
+        String out;
+        serializeJson(res, out);
+        request->send(400, "application/json", out);
+        return;
+      }
+    } else if (action == "abort") {
+      SelfCal::abort();
+    } else {
+      request->send(400, "application/json", "{\"error\":\"Unknown action\"}");
+      return;
+    }
+    request->send(200, "application/json", "{\"success\":true}");
+  });
+
   // Route POST /api/funcgen
   _server.on("/api/funcgen", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) {
@@ -991,17 +1304,32 @@ bool WebServer::begin() {
       return;
     }
     JsonDocument &cfg = ConfigStore::doc(area);
+    JsonDocument previous;
+    if (area == "scope") previous = cfg;
     cfg.clear();
     cfg = doc;
     ConfigStore::requestSave(area);
     if (area == "general") {
       WebServer::setExpectedPin(cfg["pin"].as<String>());
     } else if (area == "io") {
+      // Les canaux d'acquisition et les appareils référencent les IO :
+      // ils doivent être reconstruits avec le registre.
       IORegistry::begin();
+      Acquisition::begin();
+      DMM::begin();
+      Scope::begin();
+      FuncGen::begin();
     } else if (area == "dmm") {
       DMM::begin();
     } else if (area == "scope") {
-      Scope::begin();
+      if (previous["channels"] == cfg["channels"] && previous["trigger"] == cfg["trigger"]) {
+        // Base de temps, spectre et moyenne seuls : appliqués aux canaux en place
+        Scope::applyTimebase();
+        Scope::applySpectrum();
+        Scope::applyAverage();
+      } else {
+        Scope::begin();
+      }
     } else if (area == "funcgen") {
       FuncGen::begin();
     }
@@ -1014,6 +1342,62 @@ bool WebServer::begin() {
   return true;
 }
 
+void WebServer::loop() {
+  uint32_t seq = Scope::frameSeq();
+  uint32_t spectrumSeq = Scope::spectrumSeq();
+  bool frameDue = seq != scopeStream.lastSeq;
+  bool spectrumDue = spectrumSeq != scopeStream.lastSpectrumSeq;
+  if (!frameDue && !spectrumDue) return;
+  scopeStream.lastSeq = seq;
+  scopeStream.lastSpectrumSeq = spectrumSeq;
+  _wsScope.cleanupClients();
+  if (_wsScope.count() == 0) return;
+  if (!_wsScope.availableForWriteAll()) {
+    // Un client lent ne fait pas accumuler les trames : la suivante le rattrapera
+    scopeStream.dropped++;
+    return;
+  }
+  if (frameDue) {
+    uint32_t t0 = micros();
+    AsyncWebSocketSharedBuffer frame = std::make_shared<std::vector<uint8_t>>();
+    Scope::encodeFrame(*frame);
+    scopeStream.encodeUs = micros() - t0;
+    scopeStream.bytes = frame->size();
+    _wsScope.binaryAll(frame);
+    scopeStream.frames++;
+    scopeStream.windowFrames++;
+    uint32_t now = millis();
+    uint32_t elapsed = now - scopeStream.windowMs;
+    if (elapsed >= 1000) {
+      scopeStream.fps = scopeStream.windowFrames * 1000.0f / elapsed;
+      scopeStream.windowFrames = 0;
+      scopeStream.windowMs = now;
+    }
+  }
+  if (spectrumDue) {
+    // Spectre de la capture, sur la même socket (magie "MLSP")
+    AsyncWebSocketSharedBuffer spectrum = std::make_shared<std::vector<uint8_t>>();
+    Scope::encodeSpectrum(*spectrum);
+    _wsScope.binaryAll(spectrum);
+    scopeStream.spectra++;
+  }
+}
+
+void WebServer::scopeStats(JsonObject& out) {
+  JsonObject ws = out["ws"].to<JsonObject>();
+  ws["clients"] = _wsScope.count();
+  ws["frames"] = scopeStream.frames;
+  ws["fps"] = scopeStream.fps;
+  ws["bytes"] = scopeStream.bytes;
+  ws["encode_us"] = scopeStream.encodeUs;
+  ws["dropped"] = scopeStream.dropped;
+  ws["spectra"] = scopeStream.spectra;
+  JsonObject json = out["json"].to<JsonObject>();
+  json["requests"] = scopeStream.jsonRequests;
+  json["bytes"] = scopeStream.jsonBytes;
+  json["build_us"] = scopeStream.jsonBuildUs;
+}
+
 bool WebServer::isStarted() {
   return _started;
 }
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
 
@@ -19,8 +20,11 @@ public:
   static uint16_t port();
   /** Indique si un client s'est authentifié avec succès. */
   static bool hasAuthenticatedClient();
-  /** Boucle d'entretien (aucune action nécessaire actuellement). */
-  static void loop() {}
+  /**
+   * Boucle d'entretien : diffuse sur /ws/scope la trame binaire de
+   * chaque nouvelle capture de l'oscilloscope.
+   */
+  static void loop();
   /** Définit le code PIN attendu pour l'authentification HTTP. */
   static void setExpectedPin(int pin);
   /** Définit le code PIN attendu à partir d'une chaîne (utilisé par la config). */
@@ -31,6 +35,7 @@ private:
   static AsyncWebServer _server;
   static AsyncWebSocket _wsLogs;
   static AsyncWebSocket _wsUi;
+  static AsyncWebSocket _wsScope;
   static int _logClients;
   static int _uiClients;
   static bool _started;
@@ -38,5 +43,6 @@ private:
   static String _expectedPin;
   static void logCallback(const String& line);
   static bool checkAuth(AsyncWebServerRequest *request);
+  static void scopeStats(JsonObject& out);
   static String readRequestBody(AsyncWebServerRequest *request);
 };